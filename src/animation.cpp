@@ -6,6 +6,7 @@
 #include <helper.h>
 #include <unordered_map>
 #include "sudoku.h"
+#include "edit.h"
 
 #define FACTOR 1.0f
 
@@ -240,6 +241,8 @@ namespace Sudoku {
         void DrawString(String Text, SDL_Color Color , float alpha);
         bool DrawNumber(int row, int col, int number, SDL_Color color, float alpha);
         bool Solve();
+        int EditFrame();
+        int RenderEdit(const EditState &Edit, int Selected);
         sBoard GetsBoard();
         sRenderer GetsRenderer();
 
@@ -523,9 +526,102 @@ bool Sudoku::Frame::Solve() {
     return true;
 }
 
+// NOTE: Draw the Board being edited: selected cell highlighted, conflicts in red, user digits in blue
+int Sudoku::Frame::RenderEdit(const EditState &Edit, int Selected) {
+    SDL_Color GivenColor = {255, 255, 255, 255};
+    SDL_Color UserColor = {120, 170, 255, 255};
+    SDL_Color ConflictColor = {255, 80, 80, 255};
+    SDL_Color HighlightSelected = {70, 70, 110, 255};
+    SDL_Color HighlightConflict = {110, 30, 30, 255};
+
+    if (SDL_SetRenderDrawColor(Renderer.GetRenderer(), 0, 0, 0, 255) < 0 || SDL_RenderClear(Renderer.GetRenderer()) < 0) {
+        std::cerr << "[ERROR]: Failed to Clear Background: " << SDL_GetError() << std::endl;
+        return -1;
+    }
+
+    for (int i = 0; i < BOARD_WIDTH; ++i) {
+        for (int j = 0; j < BOARD_HEIGHT; ++j) {
+            int Cell = i * BOARD_COLS + j;
+            bool Conflict = EditConflict(&Edit, Cell);
+            if (Cell == Selected) {
+                HighlightCell(i, j, HighlightSelected);
+            } else if (Conflict) {
+                HighlightCell(i, j, HighlightConflict);
+            }
+            if (Edit.Values[Cell] != EMPTY) {
+                SDL_Color Color = Conflict ? ConflictColor : (Edit.Given[Cell] ? GivenColor : UserColor);
+                if (!DrawNumber(i, j, Edit.Values[Cell], Color, 1.0f)) {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    if (RenderFrame() < 0) return -1;
+    SDL_RenderPresent(Renderer.GetRenderer());
+    return 0;
+}
+
+// NOTE: Interactive Play: click a cell, type 1-9 to place, 0 / Backspace to clear, H for a hint, C to check
+// Every edit goes through EditState, so nothing is re-solved unless the player leaves the cached solution.
+int Sudoku::Frame::EditFrame() {
+    static EditState Edit;
+    int Values[BOARD_CELLS];
+    StoreBoard(_Board.GetBoard(), Values);
+    EditInit(&Edit, Values);
+
+    int Selected = -1;
+    if (RenderEdit(Edit, Selected) < 0) return -1;
+
+    SDL_Event event;
+    while (SDL_WaitEvent(&event)) {
+        bool Redraw = false;
+        if (event.type == SDL_QUIT) {
+            std::cout << "[INFO]: Successfully Closed the Application." << std::endl;
+            return 0;
+        } else if (event.type == SDL_MOUSEBUTTONDOWN) {
+            int i = event.button.x / CELL_WIDTH;
+            int j = event.button.y / CELL_HEIGHT;
+            if (i >= 0 && i < BOARD_WIDTH && j >= 0 && j < BOARD_HEIGHT) {
+                Selected = i * BOARD_COLS + j;
+                Redraw = true;
+            }
+        } else if (event.type == SDL_KEYDOWN) {
+            SDL_Keycode Key = event.key.keysym.sym;
+            if (Key == SDLK_ESCAPE) {
+                return 0;
+            } else if (Selected >= 0 && Key >= SDLK_1 && Key <= SDLK_9) {
+                Redraw = EditPlace(&Edit, Selected, (int)(Key - SDLK_0));
+            } else if (Selected >= 0 && (Key == SDLK_0 || Key == SDLK_BACKSPACE || Key == SDLK_DELETE)) {
+                Redraw = EditClear(&Edit, Selected);
+            } else if (Key == SDLK_h) {
+                int Cell, Value;
+                HintResult Hint = EditHint(&Edit, &Cell, &Value);
+                if (Hint == HINT_FOUND) {
+                    Selected = Cell;
+                    EditPlace(&Edit, Cell, Value);
+                    Redraw = true;
+                } else if (Hint == HINT_COMPLETE) {
+                    SDL_SetWindowTitle(Window.GetWindow(), "Sudoku - Solved");
+                } else {
+                    SDL_SetWindowTitle(Window.GetWindow(), "Sudoku - No Hint: the Board cannot be completed");
+                }
+            } else if (Key == SDLK_c) {
+                SDL_SetWindowTitle(Window.GetWindow(), EditSolvable(&Edit) ? "Sudoku - Still Solvable" : "Sudoku - Not Solvable");
+            }
+        }
+
+        if (Redraw && RenderEdit(Edit, Selected) < 0) return -1;
+    }
+    return 0;
+}
+
 // NOTE: Main Function
-int main(void) {
+int main(int argc, char **argv) {
     Sudoku::Frame F;
+    if (argc > 1 && strcmp(argv[1], "--edit") == 0) {
+        return F.EditFrame() < 0 ? 1 : 0;
+    }
     if(!F.UpdateFrame()) {
         return 1;
     }
@@ -0,0 +1,462 @@
+#include "archive.h"
+#include <sys/stat.h>
+
+// NOTE: Little-Endian Helpers so Archives are portable between Machines
+static void PutU16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void PutU32(uint8_t *p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+static void PutU64(uint8_t *p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+static uint16_t GetU16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t GetU32(const uint8_t *p) { uint32_t v = 0; for (int i = 3; i >= 0; --i) v = (v << 8) | p[i]; return v; }
+static uint64_t GetU64(const uint8_t *p) { uint64_t v = 0; for (int i = 7; i >= 0; --i) v = (v << 8) | p[i]; return v; }
+
+// NOTE: Function that maps a Text Symbol to a cell value for boards of N x N cells
+// Digits 1-9 followed by letters A-Z (either case) are values, '0' and '.' are Empty, -1 means not a cell.
+static int SymbolValue(int c, int n) {
+    int Value = -1;
+    if (c == '0' || c == '.') return EMPTY;
+    if (c >= '1' && c <= '9') Value = c - '0';
+    if (c >= 'A' && c <= 'Z') Value = c - 'A' + 10;
+    if (c >= 'a' && c <= 'z') Value = c - 'a' + 10;
+    return Value <= n ? Value : -1;
+}
+
+// NOTE: Function that reads one line and stores up to limit of its cell values
+// Returns how many cell symbols the line holds (even past limit), or -1 at the end of the file.
+static int ReadRecordLine(FILE *f, int *Values, int limit, int n) {
+    int Count = 0;
+    int c = fgetc(f);
+    if (c == EOF) {
+        return -1;
+    }
+    for (; c != EOF && c != '\n'; c = fgetc(f)) {
+        int Value = SymbolValue(c, n);
+        if (Value >= 0) {
+            if (Count < limit) Values[Count] = Value;
+            Count++;
+        }
+    }
+    return Count;
+}
+
+// NOTE: Function that reads the next puzzle record from a Text File
+// A record is either one line of N x N cells or the grid1.txt layout of N lines of N cells.
+// '0' and '.' mark Empty cells and anything else that is not a cell symbol is ignored, so lines without any
+// (blank lines, grid borders) are skipped. A line that fits neither layout is one malformed record, as are the
+// rows of a grid that is cut short, so one bad record never shifts the puzzles after it.
+static RecordStatus ParseRecord(FILE *f, int *Values, int box, bool report) {
+    int N = box * box;
+    int Cells = N * N;
+    int Count;
+    do {
+        Count = ReadRecordLine(f, Values, Cells, N);
+    } while (Count == 0);
+
+    if (Count < 0) {
+        return RECORD_END;
+    }
+    if (Count == Cells) {
+        return RECORD_PUZZLE;
+    }
+    if (Count != N) {
+        if (report) fprintf(stderr, "ERROR: Malformed Puzzle Line (%d of %d cells)\n", Count, Cells);
+        return RECORD_MALFORMED;
+    }
+
+    for (int Row = 1; Row < N; ++Row) {
+        do {
+            Count = ReadRecordLine(f, Values + Row * N, N, N);
+        } while (Count == 0);
+        if (Count != N) {
+            if (report) fprintf(stderr, "ERROR: Truncated Puzzle (row %d of %d has %d cells)\n", Row + 1, N, Count < 0 ? 0 : Count);
+            return RECORD_MALFORMED;
+        }
+    }
+    return RECORD_PUZZLE;
+}
+
+// NOTE: Function that reads the next puzzle record, reporting malformed records on stderr
+RecordStatus ReadPuzzleRecord(FILE *f, int *Values, int box) {
+    return ParseRecord(f, Values, box, true);
+}
+
+// NOTE: Same as ReadPuzzleRecord without reporting malformed records, for passes that only look for boundaries
+RecordStatus ScanPuzzleRecord(FILE *f, int *Values, int box) {
+    return ParseRecord(f, Values, box, false);
+}
+
+// NOTE: Function that reads the next puzzle from a Text File (see ReadPuzzleRecord), false at the end or on error
+bool ReadTextPuzzle(FILE *f, int Values[BOARD_CELLS]) {
+    return ReadTextPuzzleN(f, Values, 3);
+}
+
+// NOTE: Same as ReadTextPuzzle for boards made of box x box boxes (values above 9 are written A, B, ...)
+bool ReadTextPuzzleN(FILE *f, int *Values, int box) {
+    return ReadPuzzleRecord(f, Values, box) == RECORD_PUZZLE;
+}
+
+// NOTE: Function that writes a puzzle to a Text File in the grid1.txt layout
+void WriteTextPuzzle(FILE *f, const int Values[BOARD_CELLS]) {
+    char Line[BOARD_COLS + 1];
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            Line[j] = (char)('0' + Values[i * BOARD_COLS + j]);
+        }
+        Line[BOARD_COLS] = '\n';
+        fwrite(Line, 1, sizeof(Line), f);
+    }
+}
+
+// NOTE: Encode a puzzle as 81 nibbles, returns the number of bytes written
+static size_t EncodeDense(const int Values[BOARD_CELLS], uint8_t *out) {
+    memset(out, 0, PACKED_PUZZLE_SIZE);
+    for (int i = 0; i < BOARD_CELLS; ++i) {
+        out[i / 2] |= (uint8_t)((Values[i] & 0xF) << (4 * (i & 1)));
+    }
+    return PACKED_PUZZLE_SIZE;
+}
+
+// NOTE: Decode a Dense puzzle, false if a nibble is not a digit (10 to 15 only turn up in a corrupt Archive)
+static bool DecodeDense(const uint8_t *in, int Values[BOARD_CELLS]) {
+    for (int i = 0; i < BOARD_CELLS; ++i) {
+        Values[i] = (in[i / 2] >> (4 * (i & 1))) & 0xF;
+        if (Values[i] > BOARD_COLS) return false;
+    }
+    return true;
+}
+
+// NOTE: Encode a puzzle as a clue bitmap followed by the clue nibbles, returns the number of bytes written
+static size_t EncodeSparse(const int Values[BOARD_CELLS], uint8_t *out) {
+    memset(out, 0, SPARSE_PUZZLE_MAX);
+    uint8_t *Nibbles = out + CLUE_BITMAP_SIZE;
+    int Clues = 0;
+    for (int i = 0; i < BOARD_CELLS; ++i) {
+        if (Values[i] != EMPTY) {
+            out[i / 8] |= (uint8_t)(1u << (i % 8));
+            Nibbles[Clues / 2] |= (uint8_t)((Values[i] & 0xF) << (4 * (Clues & 1)));
+            ++Clues;
+        }
+    }
+    return CLUE_BITMAP_SIZE + (size_t)(Clues + 1) / 2;
+}
+
+static size_t SparseSize(const uint8_t *in) {
+    int Clues = 0;
+    for (int i = 0; i < CLUE_BITMAP_SIZE; ++i) {
+        Clues += __builtin_popcount(in[i]);
+    }
+    return CLUE_BITMAP_SIZE + (size_t)(Clues + 1) / 2;
+}
+
+// NOTE: Decode a Sparse puzzle, false if a clue is not a digit from 1 to 9
+static bool DecodeSparse(const uint8_t *in, int Values[BOARD_CELLS]) {
+    const uint8_t *Nibbles = in + CLUE_BITMAP_SIZE;
+    int Clues = 0;
+    for (int i = 0; i < BOARD_CELLS; ++i) {
+        if (in[i / 8] & (1u << (i % 8))) {
+            Values[i] = (Nibbles[Clues / 2] >> (4 * (Clues & 1))) & 0xF;
+            if (Values[i] == EMPTY || Values[i] > BOARD_COLS) return false;
+            ++Clues;
+        } else {
+            Values[i] = EMPTY;
+        }
+    }
+    return true;
+}
+
+// NOTE: Function that checks whether a file starts with the Archive Magic
+bool IsArchive(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    char Magic[4];
+    bool Result = fread(Magic, 1, sizeof(Magic), f) == sizeof(Magic) && memcmp(Magic, ARCHIVE_MAGIC, sizeof(Magic)) == 0;
+    fclose(f);
+    return Result;
+}
+
+static bool WriteHeader(FILE *f, uint16_t flags, uint32_t block_size, uint64_t count, uint64_t index_offset) {
+    uint8_t Header[ARCHIVE_HEADER_SIZE] = {0};
+    memcpy(Header, ARCHIVE_MAGIC, 4);
+    PutU16(Header + 4, ARCHIVE_VERSION);
+    PutU16(Header + 6, flags);
+    PutU32(Header + 8, block_size);
+    PutU64(Header + 12, count);
+    PutU64(Header + 20, index_offset);
+    return fseek(f, 0, SEEK_SET) == 0 && fwrite(Header, 1, sizeof(Header), f) == sizeof(Header);
+}
+
+// NOTE: Function that converts a Text File of puzzles into a packed Archive
+// Only one Block is held in memory at a time, so arbitrarily large catalogs can be converted.
+bool PackArchive(const char *text_path, const char *archive_path, uint16_t flags) {
+    FILE *In = fopen(text_path, "r");
+    if (In == NULL) {
+        fprintf(stderr, READ_FILE_FAILED, text_path);
+        return false;
+    }
+    FILE *Out = fopen(archive_path, "wb");
+    if (Out == NULL) {
+        fprintf(stderr, "ERROR: Failed To Open %s For Writing\n", archive_path);
+        fclose(In);
+        return false;
+    }
+
+    bool Sparse = (flags & ARCHIVE_FLAG_SPARSE) != 0;
+    uint8_t *Block = (uint8_t *)malloc((size_t)ARCHIVE_BLOCK_SIZE * SPARSE_PUZZLE_MAX);
+    size_t IndexCapacity = INIT_CAPACITY;
+    uint64_t *Index = (uint64_t *)malloc(sizeof(uint64_t) * IndexCapacity);
+    if (Block == NULL || Index == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        free(Block);
+        free(Index);
+        fclose(In);
+        fclose(Out);
+        return false;
+    }
+
+    bool Ok = WriteHeader(Out, flags, ARCHIVE_BLOCK_SIZE, 0, 0);
+    uint64_t Offset = ARCHIVE_HEADER_SIZE;
+    uint64_t Count = 0;
+    size_t BlockCount = 0;
+    size_t BlockBytes = 0;
+    int Values[BOARD_CELLS];
+
+    while (Ok) {
+        RecordStatus Record = ReadPuzzleRecord(In, Values, 3);
+        if (Record == RECORD_MALFORMED) {
+            fprintf(stderr, "ERROR: Puzzle %llu of %s is Malformed\n", (unsigned long long)Count, text_path);
+            Ok = false;
+            break;
+        }
+        bool Read = Record == RECORD_PUZZLE;
+        if (Read) {
+            BlockBytes += Sparse ? EncodeSparse(Values, Block + BlockBytes) : EncodeDense(Values, Block + BlockBytes);
+            ++Count;
+        }
+
+        // Flush the Block when it is full or when the input is exhausted
+        if ((Count % ARCHIVE_BLOCK_SIZE == 0 || !Read) && BlockBytes > 0) {
+            if (BlockCount + 1 >= IndexCapacity) {
+                IndexCapacity *= 2;
+                uint64_t *Grown = (uint64_t *)realloc(Index, sizeof(uint64_t) * IndexCapacity);
+                if (Grown == NULL) {
+                    fprintf(stderr, ALLOCATION_FAILED);
+                    Ok = false;
+                    break;
+                }
+                Index = Grown;
+            }
+            Index[BlockCount++] = Offset;
+            Ok = fwrite(Block, 1, BlockBytes, Out) == BlockBytes;
+            Offset += BlockBytes;
+            BlockBytes = 0;
+        }
+        if (!Read) break;
+    }
+    Ok = Ok && !ferror(In);
+    Index[BlockCount] = Offset;
+
+    // Index goes after the last Block, then the Header is rewritten with the final counts
+    uint8_t Entry[8];
+    for (size_t i = 0; Ok && i <= BlockCount; ++i) {
+        PutU64(Entry, Index[i]);
+        Ok = fwrite(Entry, 1, sizeof(Entry), Out) == sizeof(Entry);
+    }
+    Ok = Ok && WriteHeader(Out, flags, ARCHIVE_BLOCK_SIZE, Count, Offset);
+
+    free(Block);
+    free(Index);
+    fclose(In);
+    if (fclose(Out) != 0) Ok = false;
+    if (!Ok) {
+        fprintf(stderr, "ERROR: Failed To Write Archive %s\n", archive_path);
+    }
+    return Ok;
+}
+
+// NOTE: Function that converts a packed Archive back into a Text File
+bool UnpackArchive(const char *archive_path, const char *text_path) {
+    Archive a;
+    if (!OpenArchive(archive_path, &a)) {
+        return false;
+    }
+    FILE *Out = fopen(text_path, "w");
+    if (Out == NULL) {
+        fprintf(stderr, "ERROR: Failed To Open %s For Writing\n", text_path);
+        CloseArchive(&a);
+        return false;
+    }
+
+    bool Ok = true;
+    int Values[BOARD_CELLS];
+    for (uint64_t n = 0; Ok && n < a.Count; ++n) {
+        Ok = ReadArchivePuzzle(&a, n, Values);
+        if (Ok) {
+            if (n > 0) fputc('\n', Out);
+            WriteTextPuzzle(Out, Values);
+        }
+    }
+
+    CloseArchive(&a);
+    if (fclose(Out) != 0) Ok = false;
+    return Ok;
+}
+
+// NOTE: Function that opens an Archive and loads its Block Index
+bool OpenArchive(const char *path, Archive *a) {
+    memset(a, 0, sizeof(*a));
+    a->CachedBlock = -1;
+    a->File = fopen(path, "rb");
+    if (a->File == NULL) {
+        fprintf(stderr, READ_FILE_FAILED, path);
+        return false;
+    }
+
+    uint8_t Header[ARCHIVE_HEADER_SIZE];
+    if (fread(Header, 1, sizeof(Header), a->File) != sizeof(Header) || memcmp(Header, ARCHIVE_MAGIC, 4) != 0) {
+        fprintf(stderr, "ERROR: %s is not a Puzzle Archive\n", path);
+        CloseArchive(a);
+        return false;
+    }
+    if (GetU16(Header + 4) != ARCHIVE_VERSION) {
+        fprintf(stderr, "ERROR: Unsupported Archive Version %u\n", GetU16(Header + 4));
+        CloseArchive(a);
+        return false;
+    }
+
+    a->Flags = GetU16(Header + 6);
+    a->BlockSize = GetU32(Header + 8);
+    a->Count = GetU64(Header + 12);
+    uint64_t IndexOffset = GetU64(Header + 20);
+
+    // Every header field is checked against the file size before it sizes an allocation or a seek:
+    // the Blocks sit between the Header and the Index, and no puzzle takes less than its smallest encoding
+    struct stat Info;
+    if (fstat(fileno(a->File), &Info) != 0) {
+        fprintf(stderr, READ_FILE_FAILED, path);
+        CloseArchive(a);
+        return false;
+    }
+    uint64_t Size = (uint64_t)Info.st_size;
+    bool Sparse = (a->Flags & ARCHIVE_FLAG_SPARSE) != 0;
+    uint64_t MinPuzzle = Sparse ? CLUE_BITMAP_SIZE : PACKED_PUZZLE_SIZE;
+    if (a->BlockSize == 0 || a->BlockSize > ARCHIVE_MAX_BLOCK_SIZE
+        || IndexOffset < ARCHIVE_HEADER_SIZE || IndexOffset > Size
+        || a->Count > (IndexOffset - ARCHIVE_HEADER_SIZE) / MinPuzzle) {
+        fprintf(stderr, "ERROR: Corrupt Archive Header in %s\n", path);
+        CloseArchive(a);
+        return false;
+    }
+    a->BlockCount = (size_t)((a->Count + a->BlockSize - 1) / a->BlockSize);
+    if ((Size - IndexOffset) / sizeof(uint64_t) < a->BlockCount + 1) {
+        fprintf(stderr, "ERROR: Corrupt Archive Index in %s\n", path);
+        CloseArchive(a);
+        return false;
+    }
+
+    a->Index = (uint64_t *)malloc(sizeof(uint64_t) * (a->BlockCount + 1));
+    a->Block = (uint8_t *)malloc((size_t)a->BlockSize * SPARSE_PUZZLE_MAX);
+    a->Slots = (uint32_t *)malloc(sizeof(uint32_t) * a->BlockSize);
+    if (a->Index == NULL || a->Block == NULL || a->Slots == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        CloseArchive(a);
+        return false;
+    }
+
+    uint8_t Entry[8];
+    bool Ok = fseek(a->File, (long)IndexOffset, SEEK_SET) == 0;
+    for (size_t i = 0; Ok && i <= a->BlockCount; ++i) {
+        Ok = fread(Entry, 1, sizeof(Entry), a->File) == sizeof(Entry);
+        if (Ok) a->Index[i] = GetU64(Entry);
+    }
+
+    // Block offsets run upwards from the Header to the Index, and each Block is large enough for its puzzles
+    // (exactly so for Dense Blocks, which are read at a fixed stride)
+    Ok = Ok && a->Index[0] >= ARCHIVE_HEADER_SIZE && a->Index[a->BlockCount] <= IndexOffset;
+    for (size_t b = 0; Ok && b < a->BlockCount; ++b) {
+        uint64_t First = (uint64_t)b * a->BlockSize;
+        uint64_t Puzzles = a->Count - First < a->BlockSize ? a->Count - First : a->BlockSize;
+        Ok = a->Index[b] <= a->Index[b + 1] && a->Index[b + 1] - a->Index[b] >= Puzzles * MinPuzzle
+             && (Sparse ? a->Index[b + 1] - a->Index[b] <= Puzzles * SPARSE_PUZZLE_MAX
+                        : a->Index[b + 1] - a->Index[b] == Puzzles * PACKED_PUZZLE_SIZE);
+    }
+    if (!Ok) {
+        fprintf(stderr, "ERROR: Corrupt Archive Index in %s\n", path);
+        CloseArchive(a);
+        return false;
+    }
+    return true;
+}
+
+// NOTE: Function that reads Block number b of a Sparse Archive into the cache and records where each puzzle starts
+static bool LoadSparseBlock(Archive *a, size_t b) {
+    a->CachedBlock = -1;
+    size_t Bytes = (size_t)(a->Index[b + 1] - a->Index[b]);
+    if (Bytes > (size_t)a->BlockSize * SPARSE_PUZZLE_MAX
+        || fseek(a->File, (long)a->Index[b], SEEK_SET) != 0
+        || fread(a->Block, 1, Bytes, a->File) != Bytes) {
+        fprintf(stderr, "ERROR: Failed To Read Block %zu\n", b);
+        return false;
+    }
+
+    uint64_t First = (uint64_t)b * a->BlockSize;
+    uint32_t Puzzles = (uint32_t)(a->Count - First < a->BlockSize ? a->Count - First : a->BlockSize);
+    size_t Offset = 0;
+    for (uint32_t i = 0; i < Puzzles; ++i) {
+        if (Offset + CLUE_BITMAP_SIZE > Bytes || Offset + SparseSize(a->Block + Offset) > Bytes) {
+            fprintf(stderr, "ERROR: Corrupt Block %zu\n", b);
+            return false;
+        }
+        a->Slots[i] = (uint32_t)Offset;
+        Offset += SparseSize(a->Block + Offset);
+    }
+    a->CachedBlock = (int64_t)b;
+    return true;
+}
+
+// NOTE: Function that returns puzzle number n from the Archive
+// Dense Archives seek straight to the puzzle; Sparse Archives read and cache the containing Block
+// along with its puzzle offsets, so reads inside a cached Block are a lookup.
+bool ReadArchivePuzzle(Archive *a, uint64_t n, int Values[BOARD_CELLS]) {
+    if (n >= a->Count) {
+        fprintf(stderr, "ERROR: Puzzle %llu out of range (Archive holds %llu)\n", (unsigned long long)n, (unsigned long long)a->Count);
+        return false;
+    }
+    size_t BlockNumber = (size_t)(n / a->BlockSize);
+    uint32_t Slot = (uint32_t)(n % a->BlockSize);
+
+    if (!(a->Flags & ARCHIVE_FLAG_SPARSE)) {
+        uint8_t Packed[PACKED_PUZZLE_SIZE];
+        long Offset = (long)(a->Index[BlockNumber] + (uint64_t)Slot * PACKED_PUZZLE_SIZE);
+        if (fseek(a->File, Offset, SEEK_SET) != 0 || fread(Packed, 1, sizeof(Packed), a->File) != sizeof(Packed)) {
+            fprintf(stderr, "ERROR: Failed To Read Puzzle %llu\n", (unsigned long long)n);
+            return false;
+        }
+        if (!DecodeDense(Packed, Values)) {
+            fprintf(stderr, "ERROR: Corrupt Puzzle %llu in Archive\n", (unsigned long long)n);
+            return false;
+        }
+        return true;
+    }
+
+    if (a->CachedBlock != (int64_t)BlockNumber && !LoadSparseBlock(a, BlockNumber)) {
+        return false;
+    }
+    if (!DecodeSparse(a->Block + a->Slots[Slot], Values)) {
+        fprintf(stderr, "ERROR: Corrupt Puzzle %llu in Archive\n", (unsigned long long)n);
+        return false;
+    }
+    return true;
+}
+
+// NOTE: Function that closes an Archive and frees its Index
+void CloseArchive(Archive *a) {
+    if (a->File != NULL) fclose(a->File);
+    free(a->Index);
+    free(a->Block);
+    free(a->Slots);
+    a->File = NULL;
+    a->Index = NULL;
+    a->Block = NULL;
+    a->Slots = NULL;
+}
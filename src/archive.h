@@ -0,0 +1,59 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+
+// NOTE: Packed Puzzle Archive Layout (all integers little-endian)
+//
+//   Header   : ARCHIVE_HEADER_SIZE bytes (magic, version, flags, block size, puzzle count, index offset)
+//   Blocks   : up to ARCHIVE_BLOCK_SIZE puzzles each, one after the other
+//   Index    : (BlockCount + 1) x uint64 file offsets, the last one marks the end of the final block
+//
+// Every puzzle is stored either as 81 nibbles (PACKED_PUZZLE_SIZE bytes, fixed stride inside a block)
+// or, with ARCHIVE_FLAG_SPARSE, as an 81-bit clue bitmap followed by one nibble per clue.
+#define ARCHIVE_MAGIC "SDKA"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_HEADER_SIZE 32
+#define ARCHIVE_BLOCK_SIZE 4096
+#define ARCHIVE_MAX_BLOCK_SIZE 65536   // Largest Block Size a Header may ask the reader for
+#define ARCHIVE_FLAG_SPARSE 0x1
+
+#define PACKED_PUZZLE_SIZE ((BOARD_CELLS + 1) / 2)
+#define CLUE_BITMAP_SIZE ((BOARD_CELLS + 7) / 8)
+#define SPARSE_PUZZLE_MAX (CLUE_BITMAP_SIZE + PACKED_PUZZLE_SIZE)
+
+typedef struct {
+    FILE *File;            // Underlying Archive File
+    uint16_t Flags;        // ARCHIVE_FLAG_* bits from the Header
+    uint32_t BlockSize;    // Puzzles per Block
+    uint64_t Count;        // Total Number of Puzzles
+    uint64_t *Index;       // Block Offsets (BlockCount + 1 entries)
+    size_t BlockCount;     // Number of Blocks
+    uint8_t *Block;        // Cached Bytes of the last Block read
+    uint32_t *Slots;       // Offset of every puzzle inside the cached Block (Sparse Archives)
+    int64_t CachedBlock;   // Block Number held in Block (-1 if none)
+} Archive;
+
+// Result of reading one puzzle record from a Text File
+typedef enum {
+    RECORD_END,         // No puzzle left
+    RECORD_PUZZLE,      // The next puzzle was read
+    RECORD_MALFORMED,   // The next record was not a puzzle and has been skipped
+} RecordStatus;
+
+RecordStatus ReadPuzzleRecord(FILE *f, int *Values, int box);
+RecordStatus ScanPuzzleRecord(FILE *f, int *Values, int box);
+bool ReadTextPuzzle(FILE *f, int Values[BOARD_CELLS]);
+bool ReadTextPuzzleN(FILE *f, int *Values, int box);
+void WriteTextPuzzle(FILE *f, const int Values[BOARD_CELLS]);
+bool IsArchive(const char *path);
+bool PackArchive(const char *text_path, const char *archive_path, uint16_t flags);
+bool UnpackArchive(const char *archive_path, const char *text_path);
+bool OpenArchive(const char *path, Archive *a);
+bool ReadArchivePuzzle(Archive *a, uint64_t n, int Values[BOARD_CELLS]);
+void CloseArchive(Archive *a);
+
+#endif // ARCHIVE_H
@@ -0,0 +1,147 @@
+#include "batch.h"
+
+// NOTE: One candidate mask per lane; GCC lowers the vector operations to whatever the target supports
+typedef uint16_t Lanes __attribute__((vector_size(BATCH_LANES * sizeof(uint16_t))));
+typedef void (*PropagateKernel)(Lanes *Cand, Lanes *Dead);
+
+// NOTE: Cell i (0..8) of Unit u, where Units 0-8 are Rows, 9-17 Columns and 18-26 Boxes
+static inline int UnitCell(int u, int i) {
+    if (u < 9) return u * BOARD_COLS + i;
+    if (u < 18) return i * BOARD_COLS + (u - 9);
+    u -= 18;
+    return ((u / 3) * 3 + i / 3) * BOARD_COLS + (u % 3) * 3 + i % 3;
+}
+
+// NOTE: Runs naked and hidden singles on every lane until no lane changes
+// A lane of Dead becomes non-zero once its puzzle has an empty cell, a repeated digit or a digit with no place.
+static inline __attribute__((always_inline)) void PropagateBody(Lanes *Cand, Lanes *Dead) {
+    const Lanes Zero = {0};
+    const Lanes All = Zero + ALL_CANDIDATES;
+
+    for (int Pass = 0; Pass < BOARD_CELLS; ++Pass) {
+        Lanes Changed = Zero;
+        for (int u = 0; u < 27; ++u) {
+            Lanes Seen = Zero, Dup = Zero, Once = Zero, Twice = Zero;
+            for (int i = 0; i < 9; ++i) {
+                Lanes x = Cand[UnitCell(u, i)];
+                Lanes s = x & (Lanes)((x & (x - 1)) == 0);
+                Dup |= Seen & s;
+                Seen |= s;
+                Twice |= Once & x;
+                Once |= x;
+            }
+            *Dead |= Dup | (Lanes)(Once != All);
+
+            // Digits with exactly one possible cell that are not placed yet
+            Lanes Hidden = Once & ~Twice & ~Seen;
+            for (int i = 0; i < 9; ++i) {
+                int c = UnitCell(u, i);
+                Lanes x = Cand[c];
+                Lanes s = x & (Lanes)((x & (x - 1)) == 0);
+                Lanes y = x & (~Seen | s);
+                Lanes h = y & Hidden;
+                Lanes Take = (Lanes)(h != 0);
+                y = (h & Take) | (y & ~Take);
+                Changed |= x ^ y;
+                *Dead |= (Lanes)(y == 0);
+                Cand[c] = y;
+            }
+        }
+
+        bool Any = false;
+        for (int l = 0; l < BATCH_LANES; ++l) Any |= Changed[l] != 0;
+        if (!Any) break;
+    }
+}
+
+static void PropagatePortable(Lanes *Cand, Lanes *Dead) {
+    PropagateBody(Cand, Dead);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static void PropagateAvx2(Lanes *Cand, Lanes *Dead) {
+    PropagateBody(Cand, Dead);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void PropagateAvx512(Lanes *Cand, Lanes *Dead) {
+    PropagateBody(Cand, Dead);
+}
+#endif
+
+// NOTE: Function that picks the widest kernel the running CPU supports
+static PropagateKernel SelectKernel(const char **name) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        if (name) *name = "avx512";
+        return PropagateAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        if (name) *name = "avx2";
+        return PropagateAvx2;
+    }
+#endif
+    if (name) *name = "portable";
+    return PropagatePortable;
+}
+
+// NOTE: Function that returns the name of the kernel BatchSolveValues will use on this CPU
+const char *BatchKernelName(void) {
+    const char *Name = NULL;
+    SelectKernel(&Name);
+    return Name;
+}
+
+// NOTE: Function that solves count 9x9 puzzles stored back to back in Values
+// Puzzles are propagated BATCH_LANES at a time; the ones left with open cells are finished by Search
+// starting from the propagated state. Unsolvable puzzles keep their original Values.
+void BatchSolveValues(int *Values, int count, bool *Solved, BatchStats *stats) {
+    PropagateKernel Kernel = SelectKernel(NULL);
+    Lanes Cand[BOARD_CELLS];
+    Lanes Dead;
+    int Reduced[BOARD_CELLS];
+
+    for (int Start = 0; Start < count; Start += BATCH_LANES) {
+        int n = count - Start < BATCH_LANES ? count - Start : BATCH_LANES;
+
+        // Unused lanes stay fully open, which neither changes nor kills them
+        for (int c = 0; c < BOARD_CELLS; ++c) {
+            for (int l = 0; l < BATCH_LANES; ++l) {
+                int v = l < n ? Values[(Start + l) * BOARD_CELLS + c] : EMPTY;
+                Cand[c][l] = (uint16_t)(v == EMPTY ? ALL_CANDIDATES : 1u << (v - 1));
+            }
+        }
+        memset(&Dead, 0, sizeof(Dead));
+
+        Kernel(Cand, &Dead);
+
+        for (int l = 0; l < n; ++l) {
+            int *Puzzle = Values + (Start + l) * BOARD_CELLS;
+            if (Dead[l]) {
+                Solved[Start + l] = false;
+                if (stats) stats->Contradicted++;
+                continue;
+            }
+
+            bool Complete = true;
+            for (int c = 0; c < BOARD_CELLS; ++c) {
+                uint16_t x = Cand[c][l];
+                bool Single = (x & (x - 1)) == 0;
+                Reduced[c] = Single ? __builtin_ctz(x) + 1 : EMPTY;
+                Complete &= Single;
+            }
+
+            if (Complete) {
+                memcpy(Puzzle, Reduced, sizeof(Reduced));
+                Solved[Start + l] = true;
+                if (stats) stats->Propagated++;
+            } else {
+                Solved[Start + l] = SolveValues(Reduced);
+                if (Solved[Start + l]) memcpy(Puzzle, Reduced, sizeof(Reduced));
+                if (stats) stats->Branched++;
+            }
+        }
+    }
+}
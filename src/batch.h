@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+
+// NOTE: Bit-Sliced Batch Solver
+// BATCH_LANES puzzles are propagated in lockstep: every cell holds one candidate bitmask per puzzle, laid out
+// so that the same cell of all puzzles fills one 512-bit vector (two AVX2 or four SSE2 registers).
+// Naked and hidden singles run until nothing changes; puzzles that still need guessing go to Search.
+#define BATCH_LANES 32
+#define ALL_CANDIDATES 0x1FF
+
+typedef struct {
+    uint64_t Propagated;    // Puzzles fully solved by the lockstep kernel
+    uint64_t Branched;      // Puzzles handed over to Search
+    uint64_t Contradicted;  // Puzzles the kernel proved unsolvable
+} BatchStats;
+
+const char *BatchKernelName(void);
+void BatchSolveValues(int *Values, int count, bool *Solved, BatchStats *stats);
+
+#endif // BATCH_H
@@ -0,0 +1,139 @@
+#include "bench.h"
+#include "archive.h"
+
+// NOTE: Function that reads every puzzle of a corpus into a newly allocated array of Cells-sized boards
+static bool LoadCorpus(const char *path, int box, int **Values, uint64_t *count) {
+    int Cells = box * box * box * box;
+    *Values = NULL;
+    *count = 0;
+
+    if (IsArchive(path)) {
+        if (box != 3) {
+            fprintf(stderr, "ERROR: Archives only hold 9x9 Boards\n");
+            return false;
+        }
+        Archive a;
+        if (!OpenArchive(path, &a)) {
+            return false;
+        }
+        *Values = (int *)malloc(sizeof(int) * BOARD_CELLS * (a.Count > 0 ? a.Count : 1));
+        if (*Values == NULL) {
+            fprintf(stderr, ALLOCATION_FAILED);
+            CloseArchive(&a);
+            return false;
+        }
+        bool Ok = true;
+        for (uint64_t n = 0; Ok && n < a.Count; ++n) {
+            Ok = ReadArchivePuzzle(&a, n, *Values + n * BOARD_CELLS);
+        }
+        *count = a.Count;
+        CloseArchive(&a);
+        return Ok;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, READ_FILE_FAILED, path);
+        return false;
+    }
+    uint64_t Capacity = 0;
+    for (;;) {
+        if (*count == Capacity) {
+            Capacity = Capacity ? Capacity * 2 : 1024;
+            int *Grown = (int *)realloc(*Values, sizeof(int) * Cells * Capacity);
+            if (Grown == NULL) {
+                fprintf(stderr, ALLOCATION_FAILED);
+                fclose(f);
+                return false;
+            }
+            *Values = Grown;
+        }
+        RecordStatus Record = ReadPuzzleRecord(f, *Values + *count * Cells, box);
+        if (Record != RECORD_PUZZLE) {
+            if (Record == RECORD_MALFORMED) {
+                fprintf(stderr, "ERROR: Puzzle %llu of %s is Malformed\n", (unsigned long long)*count, path);
+                fclose(f);
+                return false;
+            }
+            break;
+        }
+        ++*count;
+    }
+    bool Ok = !ferror(f);
+    fclose(f);
+    return Ok;
+}
+
+// NOTE: Function that benchmarks every backend on every corpus
+bool RunBench(const char *const *corpora, int corpus_count, const SolverBackend *backends, int backend_count,
+              const StreamConfig *config) {
+    int Cells = config->Box * config->Box * config->Box * config->Box;
+    bool Ok = true;
+    char Label[512];
+
+    for (int c = 0; c < corpus_count; ++c) {
+        int *Puzzles;
+        uint64_t Count;
+        PerfSample Load;
+        PerfReading Reading;
+        memset(&Load, 0, sizeof(Load));
+        PerfStart(config->Counters, &Reading);
+        bool Loaded = LoadCorpus(corpora[c], config->Box, &Puzzles, &Count);
+        PerfStop(config->Counters, &Reading, &Load);
+        if (!Loaded) {
+            free(Puzzles);
+            Ok = false;
+            continue;
+        }
+        snprintf(Label, sizeof(Label), "%s / load", corpora[c]);
+        PrintPerfSample(Label, &Load, Count);
+
+        int *Work = (int *)malloc(sizeof(int) * Cells * (Count > 0 ? Count : 1));
+        bool *Solved = (bool *)malloc(sizeof(bool) * (Count > 0 ? Count : 1));
+        if (Work == NULL || Solved == NULL) {
+            fprintf(stderr, ALLOCATION_FAILED);
+            free(Work);
+            free(Solved);
+            free(Puzzles);
+            return false;
+        }
+
+        for (int b = 0; b < backend_count; ++b) {
+            if (config->Box != 3 && backends[b] != BACKEND_SAT) {
+                fprintf(stderr, "[INFO]: %s / %s: Skipped, only the SAT Backend supports Box Size %d\n",
+                        corpora[c], BackendName(backends[b]), config->Box);
+                continue;
+            }
+            StreamConfig Backend = *config;
+            Backend.Backend = backends[b];
+            memcpy(Work, Puzzles, sizeof(int) * Cells * Count);
+
+            PerfSample Solve;
+            memset(&Solve, 0, sizeof(Solve));
+            PerfStart(config->Counters, &Reading);
+            SolveManyWithBackend(&Backend, Work, (int)Count, Solved, NULL);
+            PerfStop(config->Counters, &Reading, &Solve);
+
+            uint64_t SolvedCount = 0, Wrong = 0;
+            for (uint64_t i = 0; i < Count; ++i) {
+                if (!Solved[i]) continue;
+                SolvedCount++;
+                if (!CheckSolution(Puzzles + i * Cells, Work + i * Cells, config->Box)) Wrong++;
+            }
+            snprintf(Label, sizeof(Label), "%s / %s", corpora[c], BackendName(backends[b]));
+            fprintf(stderr, "[INFO]: %s: %llu of %llu Solved", Label, (unsigned long long)SolvedCount,
+                    (unsigned long long)Count);
+            if (Wrong > 0) {
+                fprintf(stderr, ", %llu WRONG", (unsigned long long)Wrong);
+                Ok = false;
+            }
+            fprintf(stderr, "\n");
+            PrintPerfSample(Label, &Solve, Count);
+        }
+
+        free(Work);
+        free(Solved);
+        free(Puzzles);
+    }
+    return Ok;
+}
@@ -0,0 +1,14 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include "stream.h"
+
+// NOTE: Benchmark Mode
+// Every corpus (Text File or Archive) is loaded into memory once, then solved from a fresh copy by every backend.
+// Loading and each backend are timed separately and, when config->Counters is set, report hardware counters
+// per corpus and per backend.
+bool RunBench(const char *const *corpora, int corpus_count, const SolverBackend *backends, int backend_count,
+              const StreamConfig *config);
+
+#endif // BENCH_H
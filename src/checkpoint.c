@@ -0,0 +1,182 @@
+#include <errno.h>
+#include <fcntl.h>
+#include "checkpoint.h"
+
+// NOTE: Checkpoints are plain "key value" lines so they can be inspected by hand
+static void WriteField(FILE *f, const char *key, uint64_t value) {
+    fprintf(f, "%s %llu\n", key, (unsigned long long)value);
+}
+
+// NOTE: Schedule stats are stored as the makespan, the group counts and latency_CLASS_FIELD keys with times in
+// nanoseconds, one key per used bucket
+static void WriteScheduleStats(FILE *f, const ScheduleStats *stats) {
+    char Key[64];
+    WriteField(f, "makespan_ns", (uint64_t)(stats->Makespan * 1e9));
+    WriteField(f, "groups", stats->Groups);
+    WriteField(f, "mixed_groups", stats->MixedGroups);
+    WriteField(f, "peak_hard", (uint64_t)stats->PeakHard);
+    for (int c = 0; c < HARDNESS_CLASSES; ++c) {
+        const LatencyHistogram *h = &stats->Latency[c];
+        const char *Name = HardnessName((HardnessClass)c);
+        if (h->Puzzles == 0) continue;
+        snprintf(Key, sizeof(Key), "latency_%s_puzzles", Name);
+        WriteField(f, Key, h->Puzzles);
+        snprintf(Key, sizeof(Key), "latency_%s_total_ns", Name);
+        WriteField(f, Key, (uint64_t)(h->TotalMicros * 1e3));
+        snprintf(Key, sizeof(Key), "latency_%s_max_ns", Name);
+        WriteField(f, Key, (uint64_t)(h->MaxMicros * 1e3));
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            if (h->Count[i] == 0) continue;
+            snprintf(Key, sizeof(Key), "latency_%s_bucket_%d", Name, i);
+            WriteField(f, Key, h->Count[i]);
+        }
+    }
+}
+
+// NOTE: Function that reads one key written by WriteScheduleStats; any other key is ignored
+static void ReadScheduleField(ScheduleStats *stats, const char *key, uint64_t value) {
+    if (strcmp(key, "makespan_ns") == 0) {
+        stats->Makespan = (double)value / 1e9;
+        return;
+    }
+    if (strcmp(key, "groups") == 0) {
+        stats->Groups = value;
+        return;
+    }
+    if (strcmp(key, "mixed_groups") == 0) {
+        stats->MixedGroups = value;
+        return;
+    }
+    if (strcmp(key, "peak_hard") == 0) {
+        stats->PeakHard = (int)value;
+        return;
+    }
+    for (int c = 0; c < HARDNESS_CLASSES; ++c) {
+        LatencyHistogram *h = &stats->Latency[c];
+        char Prefix[32];
+        int Length = snprintf(Prefix, sizeof(Prefix), "latency_%s_", HardnessName((HardnessClass)c));
+        if (strncmp(key, Prefix, (size_t)Length) != 0) continue;
+        const char *Field = key + Length;
+        int Bucket;
+        if (strcmp(Field, "puzzles") == 0) h->Puzzles = value;
+        else if (strcmp(Field, "total_ns") == 0) h->TotalMicros = (double)value / 1e3;
+        else if (strcmp(Field, "max_ns") == 0) h->MaxMicros = (double)value / 1e3;
+        else if (sscanf(Field, "bucket_%d", &Bucket) == 1 && Bucket >= 0 && Bucket < LATENCY_BUCKETS) h->Count[Bucket] = value;
+        return;
+    }
+}
+
+// NOTE: Function that fsyncs the directory holding path so the rename itself is durable
+static void SyncDirectory(const char *path) {
+    char Dir[PATH_MAX];
+    const char *Slash = strrchr(path, '/');
+    if (Slash == NULL) {
+        strcpy(Dir, ".");
+    } else {
+        size_t Length = (size_t)(Slash - path);
+        if (Length == 0) Length = 1;
+        if (Length >= sizeof(Dir)) return;
+        memcpy(Dir, path, Length);
+        Dir[Length] = '\0';
+    }
+    int fd = open(Dir, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// NOTE: Function that atomically replaces the checkpoint at path with state
+bool SaveCheckpoint(const char *path, const CheckpointState *state) {
+    char Tmp[PATH_MAX];
+    if (snprintf(Tmp, sizeof(Tmp), "%s.tmp", path) >= (int)sizeof(Tmp)) {
+        fprintf(stderr, "ERROR: Checkpoint Path Too Long: %s\n", path);
+        return false;
+    }
+    FILE *f = fopen(Tmp, "w");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: Failed To Open %s For Writing: %s\n", Tmp, strerror(errno));
+        return false;
+    }
+
+    WriteField(f, "version", CHECKPOINT_VERSION);
+    WriteField(f, "input_size", state->InputSize);
+    WriteField(f, "input_mtime_ns", state->InputMtime);
+    WriteField(f, "output_device", state->OutputDevice);
+    WriteField(f, "output_inode", state->OutputInode);
+    WriteField(f, "box", state->Box);
+    WriteField(f, "backend", state->Backend);
+    WriteField(f, "input_offset", state->InputOffset);
+    WriteField(f, "output_offset", state->OutputOffset);
+    WriteField(f, "puzzles", state->Stats.Puzzles);
+    WriteField(f, "solved", state->Stats.Solved);
+    WriteField(f, "failed", state->Stats.Failed);
+    WriteField(f, "malformed", state->Stats.Malformed);
+    WriteField(f, "mismatched", state->Stats.Mismatched);
+    WriteField(f, "propagated", state->Stats.Batch.Propagated);
+    WriteField(f, "branched", state->Stats.Batch.Branched);
+    WriteField(f, "contradicted", state->Stats.Batch.Contradicted);
+    WriteScheduleStats(f, &state->Stats.Schedule);
+
+    bool Ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    if (fclose(f) != 0) Ok = false;
+    if (Ok && rename(Tmp, path) != 0) Ok = false;
+    if (!Ok) {
+        fprintf(stderr, "ERROR: Failed To Write Checkpoint %s: %s\n", path, strerror(errno));
+        remove(Tmp);
+        return false;
+    }
+    SyncDirectory(path);
+    return true;
+}
+
+// NOTE: Function that reads the checkpoint at path; a missing checkpoint is not an error (found is set to false)
+bool LoadCheckpoint(const char *path, CheckpointState *state, bool *found) {
+    memset(state, 0, sizeof(*state));
+    *found = false;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        if (errno == ENOENT) return true;
+        fprintf(stderr, READ_FILE_FAILED, path);
+        return false;
+    }
+
+    char Key[64];
+    unsigned long long Value;
+    uint64_t Version = 0;
+    while (fscanf(f, "%63s %llu", Key, &Value) == 2) {
+        if (strcmp(Key, "version") == 0) Version = Value;
+        else if (strcmp(Key, "input_size") == 0) state->InputSize = Value;
+        else if (strcmp(Key, "input_mtime_ns") == 0) state->InputMtime = Value;
+        else if (strcmp(Key, "output_device") == 0) state->OutputDevice = Value;
+        else if (strcmp(Key, "output_inode") == 0) state->OutputInode = Value;
+        else if (strcmp(Key, "box") == 0) state->Box = Value;
+        else if (strcmp(Key, "backend") == 0) state->Backend = Value;
+        else if (strcmp(Key, "input_offset") == 0) state->InputOffset = Value;
+        else if (strcmp(Key, "output_offset") == 0) state->OutputOffset = Value;
+        else if (strcmp(Key, "puzzles") == 0) state->Stats.Puzzles = Value;
+        else if (strcmp(Key, "solved") == 0) state->Stats.Solved = Value;
+        else if (strcmp(Key, "failed") == 0) state->Stats.Failed = Value;
+        else if (strcmp(Key, "malformed") == 0) state->Stats.Malformed = Value;
+        else if (strcmp(Key, "mismatched") == 0) state->Stats.Mismatched = Value;
+        else if (strcmp(Key, "propagated") == 0) state->Stats.Batch.Propagated = Value;
+        else if (strcmp(Key, "branched") == 0) state->Stats.Batch.Branched = Value;
+        else if (strcmp(Key, "contradicted") == 0) state->Stats.Batch.Contradicted = Value;
+        else ReadScheduleField(&state->Stats.Schedule, Key, Value);
+    }
+    fclose(f);
+
+    if (Version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "ERROR: Unsupported or Corrupt Checkpoint %s\n", path);
+        return false;
+    }
+    *found = true;
+    return true;
+}
+
+// NOTE: Function that deletes a checkpoint once the run it belongs to has completed
+void RemoveCheckpoint(const char *path) {
+    if (remove(path) == 0) {
+        SyncDirectory(path);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stream.h"
+
+// NOTE: Batch Checkpoints
+// A checkpoint records how far a batch run got: the input offset just after the last committed puzzle, the
+// output offset just after its solution and the stats so far. It is written to PATH.tmp, synced and renamed
+// over PATH, so a reader only ever sees a complete checkpoint. It also records what run it belongs to (the input's
+// size and modification time, the output file, the box size and the backend), and resuming with any of them changed
+// is refused.
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_EVERY 16     // Default number of STREAM_BATCH batches between checkpoints
+
+typedef struct {
+    uint64_t InputSize;         // Size of the input when the run started, to refuse resuming on a different file
+    uint64_t InputMtime;        // Modification time of the input in nanoseconds, for edits that keep its size
+    uint64_t OutputDevice;      // st_dev and st_ino of the output, to refuse resuming into a different file
+    uint64_t OutputInode;
+    uint64_t Box;
+    uint64_t Backend;           // SolverBackend the output was solved with
+    uint64_t InputOffset;
+    uint64_t OutputOffset;
+    StreamStats Stats;
+} CheckpointState;
+
+bool SaveCheckpoint(const char *path, const CheckpointState *state);
+bool LoadCheckpoint(const char *path, CheckpointState *state, bool *found);
+void RemoveCheckpoint(const char *path);
+
+#endif // CHECKPOINT_H
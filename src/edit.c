@@ -0,0 +1,200 @@
+#include "edit.h"
+
+// NOTE: Adjust the digit counts of the cell's Row, Column and Box by delta, keeping Conflicts in step
+static void CountDigit(EditState *e, int cell, int value, int delta) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    uint8_t *Counts[3] = {
+        &e->RowCount[Row][value],
+        &e->ColCount[Col][value],
+        &e->BoxCount[BOX_OF(Row, Col)][value],
+    };
+    for (int i = 0; i < 3; ++i) {
+        if (delta > 0 && ++*Counts[i] == 2) e->Conflicts++;
+        if (delta < 0 && (*Counts[i])-- == 2) e->Conflicts--;
+    }
+}
+
+// NOTE: Set a cell to value (EMPTY clears it) and update the counts and the cached solution bookkeeping
+static void SetValue(EditState *e, int cell, int value) {
+    int Old = e->Values[cell];
+    if (Old == value) return;
+
+    if (Old != EMPTY) {
+        CountDigit(e, cell, Old, -1);
+        if (e->Status == SOLUTION_CACHED && Old != e->Solution[cell]) e->Mismatches--;
+    }
+    if (value != EMPTY) {
+        CountDigit(e, cell, value, +1);
+        if (e->Status == SOLUTION_CACHED && value != e->Solution[cell]) e->Mismatches++;
+    }
+    e->Values[cell] = value;
+
+    // Removing or replacing a digit can make an unsolvable board solvable again; filling an Empty cell never can
+    if (e->Status == SOLUTION_NONE && Old != EMPTY) {
+        e->Status = SOLUTION_UNKNOWN;
+    }
+}
+
+// NOTE: Function that starts an edit session; non-Empty Values become fixed givens
+void EditInit(EditState *e, const int Values[BOARD_CELLS]) {
+    memset(e, 0, sizeof(*e));
+    e->Status = SOLUTION_UNKNOWN;
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        e->Given[c] = Values[c] != EMPTY;
+        SetValue(e, c, Values[c]);
+    }
+}
+
+// NOTE: Function that places a digit in a non-given cell; conflicting placements are allowed and tracked
+bool EditPlace(EditState *e, int cell, int value) {
+    if (cell < 0 || cell >= BOARD_CELLS || value < 1 || value > BOARD_COLS || e->Given[cell]) {
+        return false;
+    }
+    SetValue(e, cell, value);
+    return true;
+}
+
+// NOTE: Function that clears a non-given cell
+bool EditClear(EditState *e, int cell) {
+    if (cell < 0 || cell >= BOARD_CELLS || e->Given[cell]) {
+        return false;
+    }
+    SetValue(e, cell, EMPTY);
+    return true;
+}
+
+// NOTE: Function that returns the digits that can go in a cell without creating a conflict
+uint16_t EditCandidates(const EditState *e, int cell) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS, Box = BOX_OF(Row, Col);
+    uint16_t Candidates = 0;
+    for (int d = 1; d <= BOARD_COLS; ++d) {
+        if (!e->RowCount[Row][d] && !e->ColCount[Col][d] && !e->BoxCount[Box][d]) {
+            Candidates |= (uint16_t)(1u << (d - 1));
+        }
+    }
+    return Candidates;
+}
+
+// NOTE: Function that returns whether the digit in a cell is repeated in its Row, Column or Box
+bool EditConflict(const EditState *e, int cell) {
+    int Value = e->Values[cell];
+    if (Value == EMPTY) return false;
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    return e->RowCount[Row][Value] > 1 || e->ColCount[Col][Value] > 1 || e->BoxCount[BOX_OF(Row, Col)][Value] > 1;
+}
+
+// NOTE: Function that returns whether the current board can still be completed
+// Answers from the cache when possible and only re-solves after the user left the cached solution.
+bool EditSolvable(EditState *e) {
+    if (e->Conflicts > 0 || e->Status == SOLUTION_NONE) {
+        return false;
+    }
+    if (e->Status == SOLUTION_CACHED && e->Mismatches == 0) {
+        return true;
+    }
+
+    MaskBoard b;
+    if (!MaskBoardInit(&b, e->Values) || !MaskSolve(&b)) {
+        e->Status = SOLUTION_NONE;
+        return false;
+    }
+    memcpy(e->Solution, b.Values, sizeof(e->Solution));
+    e->Status = SOLUTION_CACHED;
+    e->Mismatches = 0;
+    return true;
+}
+
+// NOTE: Function that suggests a digit for the Empty cell with the fewest candidates
+HintResult EditHint(EditState *e, int *cell, int *value) {
+    if (!EditSolvable(e)) {
+        return HINT_NONE;
+    }
+    int Best = -1;
+    int BestCount = BOARD_COLS + 1;
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        if (e->Values[c] != EMPTY) continue;
+        int Count = __builtin_popcount(EditCandidates(e, c));
+        if (Count < BestCount) {
+            Best = c;
+            BestCount = Count;
+        }
+    }
+    if (Best == -1) {
+        return HINT_COMPLETE;
+    }
+    *cell = Best;
+    *value = e->Solution[Best];
+    return HINT_FOUND;
+}
+
+// NOTE: Function that prints the board with conflicting cells marked by '*'
+static void PrintEditBoard(const EditState *e) {
+    printf("+");
+    for (int j = 0; j < BOARD_COLS; ++j) printf("----");
+    printf("+\n");
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            int c = i * BOARD_COLS + j;
+            printf("|%c%d ", EditConflict(e, c) ? '*' : ' ', e->Values[c]);
+        }
+        printf("|\n+");
+        for (int j = 0; j < BOARD_COLS; ++j) printf("----");
+        printf("+\n");
+    }
+}
+
+static double ElapsedMicros(const struct timespec *start) {
+    struct timespec End;
+    clock_gettime(CLOCK_MONOTONIC, &End);
+    return (double)(End.tv_sec - start->tv_sec) * 1e6 + (double)(End.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+// NOTE: Terminal Front End: reads one command per line until 'q' or end of input
+int RunEditTerminal(EditState *e, FILE *in) {
+    printf("Commands: ROW COL DIGIT (DIGIT 0 clears), h = hint, c = check, p = print, q = quit\n");
+    PrintEditBoard(e);
+
+    char Line[MAX_LINE_COUNT];
+    for (;;) {
+        printf("> ");
+        fflush(stdout);
+        if (fgets(Line, sizeof(Line), in) == NULL) {
+            return 0;
+        }
+
+        struct timespec Start;
+        clock_gettime(CLOCK_MONOTONIC, &Start);
+        int Row, Col, Digit;
+        if (Line[0] == 'q') {
+            return 0;
+        } else if (Line[0] == 'p') {
+            PrintEditBoard(e);
+        } else if (Line[0] == 'h') {
+            int Cell, Value;
+            HintResult Hint = EditHint(e, &Cell, &Value);
+            double Micros = ElapsedMicros(&Start);
+            if (Hint == HINT_FOUND) {
+                printf("Hint: Row %d Col %d is %d (%.1f us)\n", Cell / BOARD_COLS + 1, Cell % BOARD_COLS + 1, Value, Micros);
+            } else if (Hint == HINT_COMPLETE) {
+                printf("No Hint: the Board is already Solved (%.1f us)\n", Micros);
+            } else {
+                printf("No Hint: the Board cannot be completed (%.1f us)\n", Micros);
+            }
+        } else if (Line[0] == 'c') {
+            bool Solvable = EditSolvable(e);
+            printf("%s (%.1f us)\n", Solvable ? "Still Solvable." : "Not Solvable.", ElapsedMicros(&Start));
+        } else if (sscanf(Line, "%d %d %d", &Row, &Col, &Digit) == 3 && Row >= 1 && Row <= BOARD_ROWS && Col >= 1 && Col <= BOARD_COLS) {
+            int Cell = (Row - 1) * BOARD_COLS + (Col - 1);
+            bool Ok = Digit == EMPTY ? EditClear(e, Cell) : EditPlace(e, Cell, Digit);
+            double Micros = ElapsedMicros(&Start);
+            if (!Ok) {
+                printf("Cannot change that cell.\n");
+                continue;
+            }
+            PrintEditBoard(e);
+            printf("%s (%.1f us)\n", EditConflict(e, Cell) ? "Conflict!" : "Ok.", Micros);
+        } else {
+            printf("Unknown Command.\n");
+        }
+    }
+}
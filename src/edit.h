@@ -0,0 +1,48 @@
+#ifndef EDIT_H
+#define EDIT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+#include "masks.h"
+
+// NOTE: Interactive Edit State
+// Every placement updates per-unit digit counts in O(1), so candidates and conflicts never need a rescan.
+// The last solution found is cached together with the number of filled cells that disagree with it:
+// while that number is 0 the board is known to be solvable and hints come straight from the cache,
+// and only an edit that leaves the cached solution forces a re-solve.
+typedef enum {
+    SOLUTION_UNKNOWN,
+    SOLUTION_CACHED,
+    SOLUTION_NONE,
+} SolutionStatus;
+
+typedef enum {
+    HINT_FOUND,         // cell and value hold the hint
+    HINT_COMPLETE,      // Every cell is filled and the board is solved
+    HINT_NONE,          // The board cannot be completed
+} HintResult;
+
+typedef struct {
+    int Values[BOARD_CELLS];
+    bool Given[BOARD_CELLS];
+    uint8_t RowCount[BOARD_ROWS][BOARD_COLS + 1];   // How often each digit appears in each Row
+    uint8_t ColCount[BOARD_COLS][BOARD_COLS + 1];   // ... in each Column
+    uint8_t BoxCount[BOARD_ROWS][BOARD_COLS + 1];   // ... in each Box
+    int Conflicts;                                  // (unit, digit) pairs that appear more than once
+    int Solution[BOARD_CELLS];
+    int Mismatches;                                 // Filled cells that differ from Solution
+    SolutionStatus Status;
+} EditState;
+
+void EditInit(EditState *e, const int Values[BOARD_CELLS]);
+bool EditPlace(EditState *e, int cell, int value);
+bool EditClear(EditState *e, int cell);
+uint16_t EditCandidates(const EditState *e, int cell);
+bool EditConflict(const EditState *e, int cell);
+bool EditSolvable(EditState *e);
+HintResult EditHint(EditState *e, int *cell, int *value);
+int RunEditTerminal(EditState *e, FILE *in);
+
+#endif // EDIT_H
@@ -1,43 +1,499 @@
 #include "sudoku.h"
+#include "archive.h"
+#include "stream.h"
+#include "edit.h"
+#include "portfolio.h"
+#include "checkpoint.h"
+#include "bench.h"
+#include "variants.h"
+#include "shard.h"
+#include "pindex.h"
 
 // NOTE: Declare a 2D Board of BOARD_ROWS x BOARD_COLS
 CellPool Board[BOARD_ROWS][BOARD_COLS];
 
-// NOTE: Main Function
-int main(void) {
+// NOTE: Variant Rules of the loaded Grid (Classic for plain grids and Archives)
+VariantRules Rules;
+
+// NOTE: Performance Counters used by --counters
+PerfCounters Counters;
+
+// NOTE: Function that prints how to invoke the program
+static void Usage(const char *program) {
+    fprintf(stderr, "Usage: %s [FILE [INDEX]]   (FILE may describe a diagonal, jigsaw, evenodd or killer variant)\n", program);
+    fprintf(stderr, "       %s --pack TEXT_FILE ARCHIVE [--sparse]\n", program);
+    fprintf(stderr, "       %s --unpack ARCHIVE TEXT_FILE\n", program);
+    fprintf(stderr, "       %s --edit [FILE [INDEX]]\n", program);
+    fprintf(stderr, "       %s --portfolio [--threads N] [FILE [INDEX]]\n", program);
+    fprintf(stderr, "       %s --stream [--backend search|sat|batch|portfolio] [--box B] [--threads N] [--check] [--counters]\n"
+            "              [--jobs N] [--schedule fifo|hardness] [--max-hard K] < PUZZLES > SOLUTIONS\n", program);
+    fprintf(stderr, "       %s --batch PUZZLES SOLUTIONS [--checkpoint FILE] [--every N] [stream options]\n", program);
+    fprintf(stderr, "       %s --coordinate PUZZLES SOLUTIONS [--workers N] [--shards S] [--retries R] [--launcher local|CMD]... [stream options]\n", program);
+    fprintf(stderr, "       %s --shard PUZZLES START END SOLUTIONS [stream options]\n", program);
+    fprintf(stderr, "       %s --bench [--backend B]... [--box B] [--threads N] [--counters] CORPUS...\n", program);
+    fprintf(stderr, "       %s --index CATALOG INDEX\n", program);
+    fprintf(stderr, "       %s --query INDEX PATTERN [--limit N] [--count]   (PATTERN is 81 symbols or a grid file)\n", program);
+}
+
+// NOTE: Function that loads the Board from a Text File or from puzzle INDEX of an Archive
+static bool LoadInput(const char *file_path, uint64_t index) {
+    ClassicRules(&Rules);
+    if (IsArchive(file_path)) {
+        Archive a;
+        if (!OpenArchive(file_path, &a)) {
+            return false;
+        }
+        int Values[BOARD_CELLS];
+        bool Ok = ReadArchivePuzzle(&a, index, Values);
+        CloseArchive(&a);
+        if (Ok) {
+            LoadBoard(Values, Board);
+        }
+        return Ok;
+    }
+
     // Allocate Memory For Grid
     Grid *grid = grid_alloc();
 
-    // Sudoku Grid as a Text File
-    const char *file_path = "data/grid1.txt";
-
     // Read The Sudoku text File and Load it in to the Grid
     if(!read_file(file_path, grid)) {
-        return 1;
+        grid_dealloc(grid);
+        return false;
     }
-    
-    // Initialize Board , Load Grid into Board 
+
+    // Read the Variant Rules that follow the Grid, if any
+    if (!LoadVariant(grid, &Rules)) {
+        grid_dealloc(grid);
+        return false;
+    }
+
+    // Initialize Board , Load Grid into Board
     InitBoard(grid, Board);
+    grid_dealloc(grid);
+    return true;
+}
+
+// NOTE: Function that parses one --stream / --batch option at argv[*i], advancing *i past its argument
+static bool ParseStreamOption(int argc, char **argv, int *i, StreamConfig *config) {
+    if (strcmp(argv[*i], "--backend") == 0 && *i + 1 < argc) {
+        const char *Name = argv[++*i];
+        if (strcmp(Name, "sat") == 0) {
+            config->Backend = BACKEND_SAT;
+        } else if (strcmp(Name, "portfolio") == 0) {
+            config->Backend = BACKEND_PORTFOLIO;
+        } else if (strcmp(Name, "batch") == 0) {
+            config->Backend = BACKEND_BATCH;
+        } else if (strcmp(Name, "search") == 0) {
+            config->Backend = BACKEND_SEARCH;
+        } else {
+            return false;
+        }
+    } else if (strcmp(argv[*i], "--box") == 0 && *i + 1 < argc) {
+        config->Box = atoi(argv[++*i]);
+    } else if (strcmp(argv[*i], "--threads") == 0 && *i + 1 < argc) {
+        config->Threads = atoi(argv[++*i]);
+        if (config->Threads < 1) {
+            fprintf(stderr, "ERROR: --threads needs at least 1 Thread\n");
+            return false;
+        }
+    } else if (strcmp(argv[*i], "--check") == 0) {
+        config->Check = true;
+    } else if (strcmp(argv[*i], "--counters") == 0) {
+        config->Counters = &Counters;
+    } else if (strcmp(argv[*i], "--jobs") == 0 && *i + 1 < argc) {
+        config->Schedule.Workers = atoi(argv[++*i]);
+        if (config->Schedule.Workers < 1 || config->Schedule.Workers > SCHEDULE_MAX_WORKERS) {
+            fprintf(stderr, "ERROR: --jobs needs between 1 and %d Threads\n", SCHEDULE_MAX_WORKERS);
+            return false;
+        }
+    } else if (strcmp(argv[*i], "--schedule") == 0 && *i + 1 < argc) {
+        const char *Name = argv[++*i];
+        if (strcmp(Name, "hardness") == 0) {
+            config->Schedule.HardFirst = true;
+        } else if (strcmp(Name, "fifo") == 0) {
+            config->Schedule.HardFirst = false;
+        } else {
+            return false;
+        }
+    } else if (strcmp(argv[*i], "--max-hard") == 0 && *i + 1 < argc) {
+        config->Schedule.MaxHard = atoi(argv[++*i]);
+        if (config->Schedule.MaxHard < 1) {
+            fprintf(stderr, "ERROR: --max-hard needs at least 1 Group\n");
+            return false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// NOTE: Function that reports the totals of a --stream / --batch run
+static void PrintStreamStats(const StreamConfig *config, const StreamStats *stats) {
+    fprintf(stderr, "[INFO]: Streamed %llu Puzzles (%llu Solved, %llu Failed, %llu Mismatched)\n",
+            (unsigned long long)stats->Puzzles, (unsigned long long)stats->Solved,
+            (unsigned long long)stats->Failed, (unsigned long long)stats->Mismatched);
+    if (stats->Malformed > 0) {
+        fprintf(stderr, "ERROR: %llu Malformed Records were written out as \"%.*s\"\n", (unsigned long long)stats->Malformed,
+                (int)sizeof(MALFORMED_LINE) - 2, MALFORMED_LINE);
+    }
+    if (config->Backend == BACKEND_BATCH) {
+        fprintf(stderr, "[INFO]: %s Kernel: %llu Propagated, %llu Branched, %llu Contradicted\n", BatchKernelName(),
+                (unsigned long long)stats->Batch.Propagated, (unsigned long long)stats->Batch.Branched,
+                (unsigned long long)stats->Batch.Contradicted);
+    }
+    if (config->Schedule.Workers > 0) {
+        PrintScheduleStats(&stats->Schedule);
+    }
+    if (config->Counters != NULL) {
+        PrintPerfSample("load", &stats->Load, stats->Puzzles);
+        PrintPerfSample(BackendName(config->Backend), &stats->Solve, stats->Puzzles);
+    }
+}
+
+// NOTE: Options of --query: stop after Limit matches (0 for all), or only count them
+typedef struct {
+    uint64_t Limit;
+    bool CountOnly;
+} QueryOutput;
+
+// NOTE: Function that prints one matching catalog entry (its line number, from 0)
+static bool PrintMatch(void *context, uint64_t entry) {
+    QueryOutput *out = (QueryOutput *)context;
+    if (!out->CountOnly) {
+        printf("%llu\n", (unsigned long long)entry);
+    }
+    if (out->Limit == 0) {
+        return true;
+    }
+    return --out->Limit > 0;
+}
+
+// NOTE: Main Function
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--pack") == 0) {
+        if (argc < 4) {
+            Usage(argv[0]);
+            return 1;
+        }
+        uint16_t flags = (argc > 4 && strcmp(argv[4], "--sparse") == 0) ? ARCHIVE_FLAG_SPARSE : 0;
+        return PackArchive(argv[2], argv[3], flags) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--unpack") == 0) {
+        if (argc < 4) {
+            Usage(argv[0]);
+            return 1;
+        }
+        return UnpackArchive(argv[2], argv[3]) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--stream") == 0) {
+        StreamConfig config = { BACKEND_SEARCH, 3, false, PORTFOLIO_DEFAULT, NULL, { 0, false, 0 } };
+        for (int i = 2; i < argc; ++i) {
+            if (!ParseStreamOption(argc, argv, &i, &config)) {
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (config.Counters != NULL) {
+            PerfOpen(&Counters);
+        }
+        StreamStats stats;
+        bool Ok = RunStream(stdin, STDOUT_FILENO, &config, &stats);
+        PrintStreamStats(&config, &stats);
+        return (Ok && stats.Mismatched == 0 && stats.Malformed == 0) ? 0 : 1;
+    }
 
-    // Print Initial Board 
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        if (argc < 4) {
+            Usage(argv[0]);
+            return 1;
+        }
+        StreamConfig config = { BACKEND_SEARCH, 3, false, PORTFOLIO_DEFAULT, NULL, { 0, false, 0 } };
+        const char *checkpoint_path = NULL;
+        uint64_t every = CHECKPOINT_EVERY;
+        for (int i = 4; i < argc; ++i) {
+            if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+                checkpoint_path = argv[++i];
+            } else if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+                every = strtoull(argv[++i], NULL, 10);
+            } else if (!ParseStreamOption(argc, argv, &i, &config)) {
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (config.Counters != NULL) {
+            PerfOpen(&Counters);
+        }
+        StreamStats stats;
+        bool Ok = RunBatch(argv[2], argv[3], &config, checkpoint_path, every, &stats);
+        PrintStreamStats(&config, &stats);
+        return (Ok && stats.Mismatched == 0 && stats.Malformed == 0) ? 0 : 1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--shard") == 0) {
+        if (argc < 6) {
+            Usage(argv[0]);
+            return 1;
+        }
+        StreamConfig config = { BACKEND_SEARCH, 3, false, PORTFOLIO_DEFAULT, NULL, { 0, false, 0 } };
+        for (int i = 6; i < argc; ++i) {
+            if (!ParseStreamOption(argc, argv, &i, &config)) {
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (config.Counters != NULL) {
+            PerfOpen(&Counters);
+        }
+        StreamStats stats;
+        bool Ok = RunShard(argv[2], strtoull(argv[3], NULL, 10), strtoull(argv[4], NULL, 10), argv[5], &config, &stats);
+        PrintStreamStats(&config, &stats);
+        if (!Ok || stats.Mismatched > 0) {
+            return 1;
+        }
+        return stats.Malformed == 0 ? 0 : SHARD_EXIT_MALFORMED;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--coordinate") == 0) {
+        if (argc < 4) {
+            Usage(argv[0]);
+            return 1;
+        }
+        StreamConfig stream = { BACKEND_SEARCH, 3, false, PORTFOLIO_DEFAULT, NULL, { 0, false, 0 } };
+        Launcher launchers[SHARD_MAX_LAUNCHERS];
+        CoordinatorConfig config;
+        memset(&config, 0, sizeof(config));
+        config.InPath = argv[2];
+        config.OutPath = argv[3];
+        config.Workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        config.Retries = 2;
+        config.Launchers = launchers;
+        config.WorkerArgs = argv + argc;
+        for (int i = 4; i < argc; ++i) {
+            if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+                config.Workers = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+                config.Shards = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--retries") == 0 && i + 1 < argc) {
+                config.Retries = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--launcher") == 0 && i + 1 < argc && config.LauncherCount < SHARD_MAX_LAUNCHERS) {
+                ++i;
+                launchers[config.LauncherCount++] = strcmp(argv[i], "local") == 0 ? LocalLauncher() : CommandLauncher(argv[i]);
+            } else {
+                // Everything from the first stream option on is passed to the workers as is
+                config.WorkerArgs = argv + i;
+                config.WorkerArgCount = argc - i;
+                for (; i < argc; ++i) {
+                    if (!ParseStreamOption(argc, argv, &i, &stream)) {
+                        Usage(argv[0]);
+                        return 1;
+                    }
+                }
+            }
+        }
+        if (config.LauncherCount == 0) {
+            launchers[config.LauncherCount++] = LocalLauncher();
+        }
+        if (!ValidStreamConfig(&stream)) {
+            return 1;
+        }
+        config.Box = stream.Box;
+        return RunCoordinator(&config) ? 0 : 1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        StreamConfig config = { BACKEND_SEARCH, 3, false, PORTFOLIO_DEFAULT, NULL, { 0, false, 0 } };
+        SolverBackend backends[4];
+        int backend_count = 0;
+        const char *corpora[64];
+        int corpus_count = 0;
+        for (int i = 2; i < argc; ++i) {
+            if (argv[i][0] != '-' && corpus_count < 64) {
+                corpora[corpus_count++] = argv[i];
+                continue;
+            }
+            bool backend = strcmp(argv[i], "--backend") == 0;
+            if (!ParseStreamOption(argc, argv, &i, &config)) {
+                Usage(argv[0]);
+                return 1;
+            }
+            if (backend && backend_count < 4) {
+                backends[backend_count++] = config.Backend;
+            }
+        }
+        if (corpus_count == 0) {
+            Usage(argv[0]);
+            return 1;
+        }
+        if (config.Schedule.Workers > 0 || config.Schedule.HardFirst || config.Schedule.MaxHard > 0) {
+            fprintf(stderr, "ERROR: --bench times every Backend on its own, without --jobs, --schedule or --max-hard\n");
+            return 1;
+        }
+        if (backend_count == 0) {
+            SolverBackend all[] = { BACKEND_SEARCH, BACKEND_BATCH, BACKEND_SAT, BACKEND_PORTFOLIO };
+            memcpy(backends, all, sizeof(all));
+            backend_count = 4;
+        }
+
+        if (config.Counters != NULL) {
+            PerfOpen(&Counters);
+        }
+        bool Ok = RunBench(corpora, corpus_count, backends, backend_count, &config);
+        return Ok ? 0 : 1;
+    }
+
+    if (argc > 3 && strcmp(argv[1], "--index") == 0) {
+        return BuildPatternIndex(argv[2], argv[3]) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--query") == 0) {
+        if (argc < 4) {
+            Usage(argv[0]);
+            return 1;
+        }
+        QueryOutput out = { 0, false };
+        for (int i = 4; i < argc; ++i) {
+            if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+                out.Limit = strtoull(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "--count") == 0) {
+                out.CountOnly = true;
+            } else {
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // The pattern is given inline as one 81 symbol row or as a grid file
+        FILE *f = strlen(argv[3]) == BOARD_CELLS ? fmemopen(argv[3], BOARD_CELLS, "r") : fopen(argv[3], "r");
+        if (f == NULL) {
+            fprintf(stderr, READ_FILE_FAILED, argv[3]);
+            return 1;
+        }
+        int Pattern[BOARD_CELLS];
+        bool Read = ReadTextPuzzle(f, Pattern);
+        fclose(f);
+        PatternIndex ix;
+        if (!Read || !OpenPatternIndex(argv[2], &ix)) {
+            return 1;
+        }
+
+        struct timespec Start, End;
+        clock_gettime(CLOCK_MONOTONIC, &Start);
+        uint64_t Matches = QueryPatternIndex(&ix, Pattern, PrintMatch, &out);
+        clock_gettime(CLOCK_MONOTONIC, &End);
+        double Millis = (double)(End.tv_sec - Start.tv_sec) * 1e3 + (double)(End.tv_nsec - Start.tv_nsec) / 1e6;
+        fprintf(stderr, "[INFO]: %llu of %llu Entries Match (%.3f ms, %s kernel)\n", (unsigned long long)Matches,
+                (unsigned long long)ix.Entries, Millis, IndexKernelName());
+        ClosePatternIndex(&ix);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--edit") == 0) {
+        const char *file_path = argc > 2 ? argv[2] : "data/grid1.txt";
+        uint64_t index = argc > 3 ? strtoull(argv[3], NULL, 10) : 0;
+        if (!LoadInput(file_path, index)) {
+            return 1;
+        }
+        int Values[BOARD_CELLS];
+        StoreBoard(Board, Values);
+        FreeBoard(Board);
+
+        static EditState e;
+        EditInit(&e, Values);
+        return RunEditTerminal(&e, stdin);
+    }
+    if (argc > 1 && strcmp(argv[1], "--portfolio") == 0) {
+        int Threads = PORTFOLIO_DEFAULT;
+        int Next = 2;
+        if (argc > 3 && strcmp(argv[2], "--threads") == 0) {
+            Threads = atoi(argv[3]);
+            Next = 4;
+            if (Threads < 1) {
+                fprintf(stderr, "ERROR: --threads needs at least 1 Thread\n");
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+        const char *file_path = argc > Next ? argv[Next] : "data/grid1.txt";
+        uint64_t index = argc > Next + 1 ? strtoull(argv[Next + 1], NULL, 10) : 0;
+        if (!LoadInput(file_path, index)) {
+            return 1;
+        }
+        int Values[BOARD_CELLS];
+        StoreBoard(Board, Values);
+        PrintBoard(Board);
+        FreeBoard(Board);
+
+        PortfolioMember Members[PORTFOLIO_MAX];
+        PortfolioResult Result;
+        int Count = DefaultPortfolio(Members, Threads);
+        bool Solved = PortfolioSolveValues(Values, Members, Count, &Result);
+        for (int i = 0; i < Count; ++i) {
+            printf("[INFO]: %-9s seed %016llx: %llu nodes%s\n", StrategyName(Members[i].Strategy),
+                   (unsigned long long)Members[i].Seed, (unsigned long long)Result.Nodes[i], i == Result.Winner ? " (winner)" : "");
+        }
+        if (!Solved) {
+            printf("InValid Board.\n");
+            return 1;
+        }
+        printf("Board Solved.\n");
+        LoadBoard(Values, Board);
+        PrintBoard(Board);
+        FreeBoard(Board);
+        return 0;
+    }
+    if (argc > 1 && argv[1][0] == '-') {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    // Sudoku Grid as a Text File or a packed Archive
+    const char *file_path = argc > 1 ? argv[1] : "data/grid1.txt";
+    uint64_t index = argc > 2 ? strtoull(argv[2], NULL, 10) : 0;
+
+    if (!LoadInput(file_path, index)) {
+        return 1;
+    }
+
+    // Print Initial Board
     PrintBoard(Board);
 
-    // Search For Valid Numbers for Sudoku Cell and Populate them 
+    // Variants are solved by their own constraint kernel and checked against every rule before printing
+    if (Rules.Kind != VARIANT_CLASSIC) {
+        int Puzzle[BOARD_CELLS], Values[BOARD_CELLS];
+        StoreBoard(Board, Puzzle);
+        FreeBoard(Board);
+        memcpy(Values, Puzzle, sizeof(Values));
+        if (!VariantSolveValues(Values, &Rules)) {
+            printf("InValid Board.\n");
+            return 1;
+        }
+        if (!VariantCheckSolution(Puzzle, Values, &Rules)) {
+            fprintf(stderr, "ERROR: The Solution breaks a Rule of the %s Variant\n", VariantName(Rules.Kind));
+            return 1;
+        }
+        printf("Board Solved (%s).\n", VariantName(Rules.Kind));
+        LoadBoard(Values, Board);
+        PrintBoard(Board);
+        FreeBoard(Board);
+        return 0;
+    }
+
+    // Search For Valid Numbers for Sudoku Cell and Populate them
     if(!Search(Board)) {
 
-        // Exit if failed and Free Memories Allocated 
+        // Exit if failed and Free Memories Allocated
         printf("InValid Board.\n");
         FreeBoard(Board);
-        grid_dealloc(grid);
         return 1;
     }
 
-    // Print Solved Board 
+    // Print Solved Board
     printf("Board Solved.\n");
     PrintBoard(Board);
 
     // NOTE: Free Allocated Memory
     FreeBoard(Board);
-    grid_dealloc(grid);
     return 0;
 }
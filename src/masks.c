@@ -0,0 +1,68 @@
+#include "masks.h"
+
+// NOTE: Function that loads Values into the Board, returns false if a digit repeats in a Row, Column or Box
+bool MaskBoardInit(MaskBoard *b, const int Values[BOARD_CELLS]) {
+    memset(b, 0, sizeof(*b));
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        b->Values[c] = EMPTY;
+        if (Values[c] == EMPTY) continue;
+        if (!(MaskCandidates(b, c) & (1u << (Values[c] - 1)))) {
+            return false;
+        }
+        MaskPlace(b, c, Values[c]);
+    }
+    return true;
+}
+
+// NOTE: Function that places value in an Empty cell
+void MaskPlace(MaskBoard *b, int cell, int value) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    uint16_t Bit = (uint16_t)(1u << (value - 1));
+    b->Values[cell] = value;
+    b->Row[Row] |= Bit;
+    b->Col[Col] |= Bit;
+    b->Box[BOX_OF(Row, Col)] |= Bit;
+}
+
+// NOTE: Function that empties a cell placed with MaskPlace
+void MaskClear(MaskBoard *b, int cell) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    uint16_t Bit = (uint16_t)~(1u << (b->Values[cell] - 1));
+    b->Values[cell] = EMPTY;
+    b->Row[Row] &= Bit;
+    b->Col[Col] &= Bit;
+    b->Box[BOX_OF(Row, Col)] &= Bit;
+}
+
+// NOTE: Function that solves the Board recursively, always branching on the cell with the fewest candidates
+bool MaskSolve(MaskBoard *b) {
+    uint16_t BestCandidates = 0;
+    int Best = PickFewestCandidates(b->Values, MaskBoardCandidates, b, false, &BestCandidates);
+    if (Best == CELL_DEAD_END) {
+        return false;
+    }
+    if (Best == CELL_NONE) {
+        return true;
+    }
+
+    while (BestCandidates) {
+        int Value = __builtin_ctz(BestCandidates) + 1;
+        BestCandidates &= (uint16_t)(BestCandidates - 1);
+        MaskPlace(b, Best, Value);
+        if (MaskSolve(b)) {
+            return true;
+        }
+        MaskClear(b, Best);
+    }
+    return false;
+}
+
+// NOTE: Function that Solves a flat row-major array of Values in place with the bitmask search
+bool MaskSolveValues(int Values[BOARD_CELLS]) {
+    MaskBoard b;
+    if (!MaskBoardInit(&b, Values) || !MaskSolve(&b)) {
+        return false;
+    }
+    memcpy(Values, b.Values, sizeof(b.Values));
+    return true;
+}
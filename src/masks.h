@@ -0,0 +1,68 @@
+#ifndef MASKS_H
+#define MASKS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+
+// NOTE: Bitmask Board
+// Bit (d - 1) of Row[r], Col[c] and Box[b] is set when digit d is already placed in that Row, Column or Box,
+// so the candidates of a cell are the digits missing from all three masks.
+#define DIGIT_MASK 0x1FF
+#define BOX_OF(row, col) (((row) / 3) * 3 + (col) / 3)
+
+typedef struct {
+    int Values[BOARD_CELLS];
+    uint16_t Row[BOARD_ROWS];
+    uint16_t Col[BOARD_COLS];
+    uint16_t Box[BOARD_ROWS];
+} MaskBoard;
+
+bool MaskBoardInit(MaskBoard *b, const int Values[BOARD_CELLS]);
+void MaskPlace(MaskBoard *b, int cell, int value);
+void MaskClear(MaskBoard *b, int cell);
+bool MaskSolve(MaskBoard *b);
+bool MaskSolveValues(int Values[BOARD_CELLS]);
+
+// NOTE: Function that returns the candidate digits of a cell as a bitmask
+static inline uint16_t MaskCandidates(const MaskBoard *b, int cell) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    return (uint16_t)(~(b->Row[Row] | b->Col[Col] | b->Box[BOX_OF(Row, Col)]) & DIGIT_MASK);
+}
+
+// NOTE: Cell Selection shared by the bitmask searches
+// The candidate function is a parameter so the same loop serves MaskBoard and every variant board; the helper
+// is always inlined, so each caller gets its own copy with the candidate function called directly.
+#define CELL_DEAD_END (-2)  // An Empty cell has no candidate left
+#define CELL_NONE (-1)      // No Empty cell left
+
+typedef uint16_t (*CellCandidates)(const void *board, int cell);
+
+// NOTE: Function that picks the Empty cell with the fewest candidates and stores them in *candidates
+// first_empty takes the first Empty cell in row-major order instead; either way a dead end is reported.
+static inline __attribute__((always_inline)) int PickFewestCandidates(const int Values[BOARD_CELLS],
+        CellCandidates Candidates, const void *board, bool first_empty, uint16_t *candidates) {
+    int Best = CELL_NONE;
+    int BestCount = BOARD_COLS + 1;
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        if (Values[c] != EMPTY) continue;
+        uint16_t Mask = Candidates(board, c);
+        int Count = __builtin_popcount(Mask);
+        if (Count == 0) {
+            return CELL_DEAD_END;
+        }
+        if (Count < BestCount) {
+            Best = c;
+            BestCount = Count;
+            *candidates = Mask;
+            if (Count == 1 || first_empty) break;
+        }
+    }
+    return Best;
+}
+
+static inline uint16_t MaskBoardCandidates(const void *board, int cell) {
+    return MaskCandidates((const MaskBoard *)board, cell);
+}
+
+#endif // MASKS_H
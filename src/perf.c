@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perf.h"
+
+// NOTE: Event type / config of every CounterKind, in CounterKind order
+static const struct {
+    const char *Name;
+    uint32_t Type;
+    uint64_t Config;
+} Counters[COUNTER_COUNT] = {
+    { "task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "L1D-misses", PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { "LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+const char *CounterName(CounterKind k) {
+    return Counters[k].Name;
+}
+
+// NOTE: Function that returns the monotonic wall clock in seconds
+double Now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+// NOTE: Function that opens every counter the kernel lets us have; returns false only if none could be opened
+bool PerfOpen(PerfCounters *p) {
+    p->Enabled = false;
+    for (int k = 0; k < COUNTER_COUNT; ++k) {
+        struct perf_event_attr Attr;
+        memset(&Attr, 0, sizeof(Attr));
+        Attr.size = sizeof(Attr);
+        Attr.type = Counters[k].Type;
+        Attr.config = Counters[k].Config;
+        Attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        Attr.exclude_kernel = 1;
+        Attr.exclude_hv = 1;
+        Attr.inherit = 1;   // Also count the Portfolio threads
+
+        p->Fd[k] = (int)syscall(SYS_perf_event_open, &Attr, 0, -1, -1, 0);
+        if (p->Fd[k] < 0) {
+            fprintf(stderr, "[INFO]: Counter %s Unavailable: %s\n", Counters[k].Name, strerror(errno));
+            continue;
+        }
+        p->Enabled = true;
+    }
+    if (!p->Enabled) {
+        fprintf(stderr, "[INFO]: No Performance Counters Available, Reporting them as n/a\n");
+    }
+    return p->Enabled;
+}
+
+void PerfClose(PerfCounters *p) {
+    for (int k = 0; k < COUNTER_COUNT; ++k) {
+        if (p->Fd[k] >= 0) close(p->Fd[k]);
+        p->Fd[k] = -1;
+    }
+    p->Enabled = false;
+}
+
+// NOTE: Function that takes a reading of all open counters; p may be NULL to only take the time
+void PerfStart(const PerfCounters *p, PerfReading *start) {
+    memset(start, 0, sizeof(*start));
+    for (int k = 0; p != NULL && k < COUNTER_COUNT; ++k) {
+        uint64_t Buf[3];
+        if (p->Fd[k] >= 0 && read(p->Fd[k], Buf, sizeof(Buf)) == (ssize_t)sizeof(Buf)) {
+            start->Value[k] = Buf[0];
+            start->TimeEnabled[k] = Buf[1];
+            start->TimeRunning[k] = Buf[2];
+        }
+    }
+    start->Seconds = Now();
+}
+
+// NOTE: Function that adds everything counted since start to sample
+void PerfStop(const PerfCounters *p, const PerfReading *start, PerfSample *sample) {
+    sample->Seconds += Now() - start->Seconds;
+    sample->Counted = sample->Counted || p != NULL;
+    for (int k = 0; p != NULL && k < COUNTER_COUNT; ++k) {
+        uint64_t Buf[3];
+        if (p->Fd[k] < 0 || read(p->Fd[k], Buf, sizeof(Buf)) != (ssize_t)sizeof(Buf)) {
+            continue;
+        }
+        double Value = (double)(Buf[0] - start->Value[k]);
+        uint64_t Enabled = Buf[1] - start->TimeEnabled[k];
+        uint64_t Running = Buf[2] - start->TimeRunning[k];
+        if (Running == 0) {
+            // Never scheduled on the PMU during this interval (too many counters for the hardware)
+            continue;
+        }
+        if (Running < Enabled) {
+            Value *= (double)Enabled / (double)Running;
+        }
+        sample->Value[k] += Value;
+        sample->Valid[k] = true;
+    }
+}
+
+// NOTE: Function that prints one line of totals and one line of per-puzzle counters for a measured phase
+void PrintPerfSample(const char *label, const PerfSample *sample, uint64_t puzzles) {
+    double PerPuzzle = puzzles > 0 ? (double)puzzles : 1.0;
+    fprintf(stderr, "[INFO]: %s: %llu Puzzles in %.3f s (%.2f us/puzzle)\n", label, (unsigned long long)puzzles,
+            sample->Seconds, sample->Seconds * 1e6 / PerPuzzle);
+
+    if (!sample->Counted) {
+        return;
+    }
+
+    fprintf(stderr, "[INFO]: %s:", label);
+    for (int k = 0; k < COUNTER_COUNT; ++k) {
+        if (k == COUNTER_TASK_CLOCK) {
+            if (sample->Valid[k]) fprintf(stderr, " %s %.2f us/puzzle", Counters[k].Name, sample->Value[k] / 1e3 / PerPuzzle);
+            else fprintf(stderr, " %s n/a", Counters[k].Name);
+        } else if (sample->Valid[k]) {
+            fprintf(stderr, ", %s %.1f/puzzle", Counters[k].Name, sample->Value[k] / PerPuzzle);
+        } else {
+            fprintf(stderr, ", %s n/a", Counters[k].Name);
+        }
+    }
+    if (sample->Valid[COUNTER_CYCLES] && sample->Valid[COUNTER_INSTRUCTIONS] && sample->Value[COUNTER_CYCLES] > 0) {
+        fprintf(stderr, ", IPC %.2f", sample->Value[COUNTER_INSTRUCTIONS] / sample->Value[COUNTER_CYCLES]);
+    } else {
+        fprintf(stderr, ", IPC n/a");
+    }
+    fprintf(stderr, "\n");
+}
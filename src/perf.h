@@ -0,0 +1,48 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// NOTE: Hardware Performance Counters
+// Each counter is opened on its own with perf_event_open (user space only, following threads created later),
+// so a kernel or VM that lacks some events still reports the rest. Counters are never reset: a phase is
+// measured as the difference between two readings, scaled up when the kernel had to multiplex the counter.
+typedef enum {
+    COUNTER_TASK_CLOCK,     // Software counter, available even when the hardware ones are not
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT,
+} CounterKind;
+
+typedef struct {
+    int Fd[COUNTER_COUNT];      // -1 when the counter could not be opened
+    bool Enabled;               // Whether any counter is open
+} PerfCounters;
+
+typedef struct {
+    uint64_t Value[COUNTER_COUNT];
+    uint64_t TimeEnabled[COUNTER_COUNT];
+    uint64_t TimeRunning[COUNTER_COUNT];
+    double Seconds;
+} PerfReading;
+
+typedef struct {
+    double Value[COUNTER_COUNT];    // Accumulated (scaled) counts of all measured intervals
+    bool Valid[COUNTER_COUNT];
+    double Seconds;                 // Accumulated wall clock time
+    bool Counted;                   // Whether counters were asked for, so unavailable ones print as n/a
+} PerfSample;
+
+const char *CounterName(CounterKind k);
+double Now(void);
+bool PerfOpen(PerfCounters *p);
+void PerfClose(PerfCounters *p);
+void PerfStart(const PerfCounters *p, PerfReading *start);
+void PerfStop(const PerfCounters *p, const PerfReading *start, PerfSample *sample);
+void PrintPerfSample(const char *label, const PerfSample *sample, uint64_t puzzles);
+
+#endif // PERF_H
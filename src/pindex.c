@@ -0,0 +1,422 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pindex.h"
+
+// NOTE: 512 bits of a bitmap container; GCC lowers the vector operations to whatever the target supports
+typedef uint64_t Words __attribute__((vector_size(INDEX_ALIGN)));
+#define WORD_VECTORS (INDEX_BITMAP_WORDS * 8 / INDEX_ALIGN)
+typedef void (*IntersectKernel)(Words *Out, const Words *const *In, int count);
+
+/* Building */
+
+// NOTE: Function that finds the last whitespace separated field of line and decodes it as a grid
+static bool ParseCatalogLine(const char *line, size_t length, uint8_t Grid[BOARD_CELLS]) {
+    size_t End = length;
+    while (End > 0 && (line[End - 1] == '\n' || line[End - 1] == '\r' || line[End - 1] == ' ' || line[End - 1] == '\t')) --End;
+    size_t Start = End;
+    while (Start > 0 && line[Start - 1] != ' ' && line[Start - 1] != '\t') --Start;
+    if (End - Start != BOARD_CELLS) {
+        return false;
+    }
+    for (int i = 0; i < BOARD_CELLS; ++i) {
+        char c = line[Start + i];
+        if (c >= '1' && c <= '9') Grid[i] = (uint8_t)(c - '0');
+        else if (c == '0' || c == '.') Grid[i] = EMPTY;
+        else return false;
+    }
+    return true;
+}
+
+typedef struct {
+    FILE *Out;
+    uint64_t Offset;
+    IndexContainer *Containers[INDEX_LISTS];
+    uint32_t Count[INDEX_LISTS];
+    uint32_t Capacity[INDEX_LISTS];
+    uint8_t *Grids;         // INDEX_CHUNK grids of the chunk being collected
+    uint16_t *Members;      // Entries of the chunk, grouped by list
+    uint64_t *Bitmap;
+} IndexBuilder;
+
+static bool WriteBytes(IndexBuilder *b, const void *data, size_t n) {
+    if (fwrite(data, 1, n, b->Out) != n) {
+        return false;
+    }
+    b->Offset += n;
+    return true;
+}
+
+static bool Pad(IndexBuilder *b, uint64_t align) {
+    static const uint8_t Zero[INDEX_ALIGN] = {0};
+    size_t n = (size_t)((align - b->Offset % align) % align);
+    return WriteBytes(b, Zero, n);
+}
+
+// NOTE: Function that writes the containers of one chunk of count grids, chunk number key
+static bool FlushChunk(IndexBuilder *b, uint32_t key, uint32_t count) {
+    uint32_t Counts[INDEX_LISTS] = {0};
+    uint32_t Start[INDEX_LISTS];
+    for (uint32_t e = 0; e < count; ++e) {
+        const uint8_t *Grid = b->Grids + (size_t)e * BOARD_CELLS;
+        for (int c = 0; c < BOARD_CELLS; ++c) {
+            if (Grid[c] != EMPTY) Counts[c * BOARD_COLS + Grid[c] - 1]++;
+        }
+    }
+    uint32_t Sum = 0;
+    for (int l = 0; l < INDEX_LISTS; ++l) {
+        Start[l] = Sum;
+        Sum += Counts[l];
+    }
+    uint32_t Fill[INDEX_LISTS];
+    memcpy(Fill, Start, sizeof(Fill));
+    for (uint32_t e = 0; e < count; ++e) {
+        const uint8_t *Grid = b->Grids + (size_t)e * BOARD_CELLS;
+        for (int c = 0; c < BOARD_CELLS; ++c) {
+            if (Grid[c] != EMPTY) b->Members[Fill[c * BOARD_COLS + Grid[c] - 1]++] = (uint16_t)e;
+        }
+    }
+
+    for (int l = 0; l < INDEX_LISTS; ++l) {
+        if (Counts[l] == 0) continue;
+        const uint16_t *Members = b->Members + Start[l];
+        bool Ok;
+        if (Counts[l] <= INDEX_ARRAY_MAX) {
+            Ok = WriteBytes(b, Members, sizeof(uint16_t) * Counts[l]);
+        } else {
+            memset(b->Bitmap, 0, sizeof(uint64_t) * INDEX_BITMAP_WORDS);
+            for (uint32_t i = 0; i < Counts[l]; ++i) b->Bitmap[Members[i] / 64] |= 1ull << (Members[i] % 64);
+            Ok = Pad(b, INDEX_ALIGN);
+            Ok = Ok && WriteBytes(b, b->Bitmap, sizeof(uint64_t) * INDEX_BITMAP_WORDS);
+        }
+        if (!Ok) {
+            return false;
+        }
+        uint64_t DataOffset = b->Offset - (Counts[l] <= INDEX_ARRAY_MAX ? sizeof(uint16_t) * Counts[l]
+                                                                         : sizeof(uint64_t) * INDEX_BITMAP_WORDS);
+
+        if (b->Count[l] == b->Capacity[l]) {
+            uint32_t Capacity = b->Capacity[l] ? b->Capacity[l] * 2 : 16;
+            IndexContainer *Grown = (IndexContainer *)realloc(b->Containers[l], sizeof(IndexContainer) * Capacity);
+            if (Grown == NULL) {
+                fprintf(stderr, ALLOCATION_FAILED);
+                return false;
+            }
+            b->Containers[l] = Grown;
+            b->Capacity[l] = Capacity;
+        }
+        IndexContainer *Container = &b->Containers[l][b->Count[l]++];
+        Container->DataOffset = DataOffset;
+        Container->Key = key;
+        Container->Cardinality = Counts[l];
+    }
+    return true;
+}
+
+static bool WriteIndexHeader(FILE *f, uint64_t entries, uint64_t directory_offset) {
+    IndexHeader Header;
+    memset(&Header, 0, sizeof(Header));
+    memcpy(Header.Magic, INDEX_MAGIC, 4);
+    Header.Version = INDEX_VERSION;
+    Header.ByteOrder = INDEX_BYTE_ORDER;
+    Header.Lists = INDEX_LISTS;
+    Header.Entries = entries;
+    Header.DirectoryOffset = directory_offset;
+    return fseeko(f, 0, SEEK_SET) == 0 && fwrite(&Header, 1, sizeof(Header), f) == sizeof(Header);
+}
+
+// NOTE: Function that reads a catalog (one grid per line) and writes its Pattern Index
+bool BuildPatternIndex(const char *catalog_path, const char *index_path) {
+    FILE *In = fopen(catalog_path, "r");
+    if (In == NULL) {
+        fprintf(stderr, READ_FILE_FAILED, catalog_path);
+        return false;
+    }
+    FILE *Out = fopen(index_path, "wb");
+    if (Out == NULL) {
+        fprintf(stderr, "ERROR: Failed To Open %s For Writing: %s\n", index_path, strerror(errno));
+        fclose(In);
+        return false;
+    }
+
+    IndexBuilder *b = (IndexBuilder *)calloc(1, sizeof(IndexBuilder));
+    if (b != NULL) {
+        b->Grids = (uint8_t *)malloc((size_t)INDEX_CHUNK * BOARD_CELLS);
+        b->Members = (uint16_t *)malloc(sizeof(uint16_t) * (size_t)INDEX_CHUNK * BOARD_CELLS);
+        b->Bitmap = (uint64_t *)malloc(sizeof(uint64_t) * INDEX_BITMAP_WORDS);
+    }
+    bool Ok = b != NULL && b->Grids != NULL && b->Members != NULL && b->Bitmap != NULL;
+    if (!Ok) {
+        fprintf(stderr, ALLOCATION_FAILED);
+    } else {
+        b->Out = Out;
+        Ok = WriteIndexHeader(Out, 0, 0);
+        b->Offset = sizeof(IndexHeader);
+    }
+
+    // Data: one chunk of INDEX_CHUNK entries at a time
+    uint64_t Entries = 0;
+    uint32_t InChunk = 0;
+    char *Line = NULL;
+    size_t LineCapacity = 0;
+    ssize_t Length;
+    while (Ok && (Length = getline(&Line, &LineCapacity, In)) >= 0) {
+        if (!ParseCatalogLine(Line, (size_t)Length, b->Grids + (size_t)InChunk * BOARD_CELLS)) {
+            fprintf(stderr, "ERROR: Line %llu of %s has no %d Cell Grid\n", (unsigned long long)Entries + 1,
+                    catalog_path, BOARD_CELLS);
+            Ok = false;
+            break;
+        }
+        Entries++;
+        if (++InChunk == INDEX_CHUNK) {
+            Ok = FlushChunk(b, (uint32_t)((Entries - 1) / INDEX_CHUNK), InChunk);
+            InChunk = 0;
+        }
+    }
+    free(Line);
+    Ok = Ok && !ferror(In);
+    if (Ok && InChunk > 0) {
+        Ok = FlushChunk(b, (uint32_t)((Entries - 1) / INDEX_CHUNK), InChunk);
+    }
+
+    // Containers of every list, then the Directory, then the final Header
+    IndexList Directory[INDEX_LISTS];
+    memset(Directory, 0, sizeof(Directory));
+    Ok = Ok && Pad(b, 8);
+    for (int l = 0; Ok && l < INDEX_LISTS; ++l) {
+        Directory[l].ContainerOffset = b->Offset;
+        Directory[l].ContainerCount = b->Count[l];
+        for (uint32_t i = 0; i < b->Count[l]; ++i) Directory[l].Cardinality += b->Containers[l][i].Cardinality;
+        Ok = WriteBytes(b, b->Containers[l], sizeof(IndexContainer) * b->Count[l]);
+    }
+    uint64_t DirectoryOffset = Ok ? b->Offset : 0;
+    Ok = Ok && WriteBytes(b, Directory, sizeof(Directory));
+    Ok = Ok && WriteIndexHeader(Out, Entries, DirectoryOffset);
+
+    if (fclose(Out) != 0) Ok = false;
+    fclose(In);
+    if (b != NULL) {
+        for (int l = 0; l < INDEX_LISTS; ++l) free(b->Containers[l]);
+        free(b->Grids);
+        free(b->Members);
+        free(b->Bitmap);
+        free(b);
+    }
+    if (!Ok) {
+        fprintf(stderr, "ERROR: Failed To Write Index %s\n", index_path);
+        remove(index_path);
+        return false;
+    }
+    fprintf(stderr, "[INFO]: Indexed %llu Entries of %s\n", (unsigned long long)Entries, catalog_path);
+    return true;
+}
+
+/* Reading */
+
+// NOTE: Function that maps an index and checks that every list and container lies inside the file
+bool OpenPatternIndex(const char *path, PatternIndex *ix) {
+    memset(ix, 0, sizeof(*ix));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, READ_FILE_FAILED, path);
+        return false;
+    }
+    struct stat Info;
+    if (fstat(fd, &Info) != 0 || (size_t)Info.st_size < sizeof(IndexHeader)) {
+        fprintf(stderr, "ERROR: %s is not a Pattern Index\n", path);
+        close(fd);
+        return false;
+    }
+    void *Map = mmap(NULL, (size_t)Info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (Map == MAP_FAILED) {
+        fprintf(stderr, "ERROR: Failed To Map %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    ix->Map = (const uint8_t *)Map;
+    ix->Size = (size_t)Info.st_size;
+
+    const IndexHeader *Header = (const IndexHeader *)ix->Map;
+    bool Ok = memcmp(Header->Magic, INDEX_MAGIC, 4) == 0 && Header->Version == INDEX_VERSION
+              && Header->ByteOrder == INDEX_BYTE_ORDER && Header->Lists == INDEX_LISTS
+              && Header->DirectoryOffset % 8 == 0
+              && Header->DirectoryOffset <= ix->Size && ix->Size - Header->DirectoryOffset >= sizeof(IndexList) * INDEX_LISTS;
+    if (Ok) {
+        ix->Entries = Header->Entries;
+        ix->Lists = (const IndexList *)(ix->Map + Header->DirectoryOffset);
+    }
+    for (int l = 0; Ok && l < INDEX_LISTS; ++l) {
+        const IndexList *List = &ix->Lists[l];
+        Ok = List->ContainerOffset % 8 == 0 && List->ContainerOffset <= ix->Size
+             && (ix->Size - List->ContainerOffset) / sizeof(IndexContainer) >= List->ContainerCount;
+        const IndexContainer *Containers = (const IndexContainer *)(ix->Map + List->ContainerOffset);
+        for (uint32_t i = 0; Ok && i < List->ContainerCount; ++i) {
+            const IndexContainer *c = &Containers[i];
+            bool Bitmap = c->Cardinality > INDEX_ARRAY_MAX;
+            uint64_t Bytes = Bitmap ? sizeof(uint64_t) * INDEX_BITMAP_WORDS : sizeof(uint16_t) * (uint64_t)c->Cardinality;
+            Ok = c->Cardinality <= INDEX_CHUNK && c->DataOffset <= ix->Size && ix->Size - c->DataOffset >= Bytes
+                 && c->DataOffset % (Bitmap ? INDEX_ALIGN : 2) == 0 && (i == 0 || c->Key > Containers[i - 1].Key);
+        }
+    }
+    if (!Ok) {
+        fprintf(stderr, "ERROR: %s is not a valid Pattern Index (version %u expected)\n", path, INDEX_VERSION);
+        ClosePatternIndex(ix);
+        return false;
+    }
+    return true;
+}
+
+void ClosePatternIndex(PatternIndex *ix) {
+    if (ix->Map != NULL) {
+        munmap((void *)ix->Map, ix->Size);
+    }
+    memset(ix, 0, sizeof(*ix));
+}
+
+// NOTE: ANDs count bitmap containers into Out, one 512-bit vector at a time
+static inline __attribute__((always_inline)) void IntersectBody(Words *Out, const Words *const *In, int count) {
+    for (int w = 0; w < WORD_VECTORS; ++w) {
+        Words x = In[0][w];
+        for (int i = 1; i < count; ++i) x &= In[i][w];
+        Out[w] = x;
+    }
+}
+
+static void IntersectPortable(Words *Out, const Words *const *In, int count) {
+    IntersectBody(Out, In, count);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static void IntersectAvx2(Words *Out, const Words *const *In, int count) {
+    IntersectBody(Out, In, count);
+}
+
+__attribute__((target("avx512f")))
+static void IntersectAvx512(Words *Out, const Words *const *In, int count) {
+    IntersectBody(Out, In, count);
+}
+#endif
+
+// NOTE: Function that picks the widest intersection kernel the CPU supports
+static IntersectKernel SelectIntersect(const char **name) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        if (name) *name = "avx512";
+        return IntersectAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        if (name) *name = "avx2";
+        return IntersectAvx2;
+    }
+#endif
+    if (name) *name = "portable";
+    return IntersectPortable;
+}
+
+const char *IndexKernelName(void) {
+    const char *Name = NULL;
+    SelectIntersect(&Name);
+    return Name;
+}
+
+static bool ContainerHas(const PatternIndex *ix, const IndexContainer *c, uint16_t value) {
+    if (c->Cardinality > INDEX_ARRAY_MAX) {
+        const uint64_t *Bitmap = (const uint64_t *)(ix->Map + c->DataOffset);
+        return (Bitmap[value / 64] >> (value % 64)) & 1;
+    }
+    const uint16_t *Array = (const uint16_t *)(ix->Map + c->DataOffset);
+    uint32_t Low = 0, High = c->Cardinality;
+    while (Low < High) {
+        uint32_t Mid = (Low + High) / 2;
+        if (Array[Mid] < value) Low = Mid + 1;
+        else High = Mid;
+    }
+    return Low < c->Cardinality && Array[Low] == value;
+}
+
+static int ByCardinality(const void *a, const void *b) {
+    uint64_t x = (*(const IndexList *const *)a)->Cardinality, y = (*(const IndexList *const *)b)->Cardinality;
+    return (x > y) - (x < y);
+}
+
+// NOTE: Function that reports every entry whose grid agrees with all non-Empty cells of Pattern
+// The posting lists of the given cells are intersected chunk by chunk, starting from the shortest list.
+// Returns the number of entries passed to match.
+uint64_t QueryPatternIndex(const PatternIndex *ix, const int Pattern[BOARD_CELLS], MatchCallback match, void *context) {
+    const IndexList *Lists[BOARD_CELLS];
+    int Count = 0;
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        if (Pattern[c] >= 1 && Pattern[c] <= BOARD_COLS) {
+            Lists[Count++] = &ix->Lists[c * BOARD_COLS + Pattern[c] - 1];
+        }
+    }
+
+    uint64_t Matches = 0;
+    if (Count == 0) {
+        for (uint64_t e = 0; e < ix->Entries; ++e) {
+            Matches++;
+            if (!match(context, e)) break;
+        }
+        return Matches;
+    }
+    qsort(Lists, (size_t)Count, sizeof(Lists[0]), ByCardinality);
+
+    IntersectKernel Intersect = SelectIntersect(NULL);
+    Words Scratch[WORD_VECTORS];
+    const IndexContainer *Chunk[BOARD_CELLS];
+    uint32_t Cursor[BOARD_CELLS] = {0};
+
+    const IndexContainer *Driver = (const IndexContainer *)(ix->Map + Lists[0]->ContainerOffset);
+    for (uint32_t d = 0; d < Lists[0]->ContainerCount; ++d) {
+        uint32_t Key = Driver[d].Key;
+
+        // Find the container for this chunk in every other list; skip the chunk if one has none
+        bool Present = true;
+        bool AllBitmaps = Driver[d].Cardinality > INDEX_ARRAY_MAX;
+        int Smallest = 0;
+        Chunk[0] = &Driver[d];
+        for (int i = 1; Present && i < Count; ++i) {
+            const IndexContainer *Containers = (const IndexContainer *)(ix->Map + Lists[i]->ContainerOffset);
+            while (Cursor[i] < Lists[i]->ContainerCount && Containers[Cursor[i]].Key < Key) Cursor[i]++;
+            Present = Cursor[i] < Lists[i]->ContainerCount && Containers[Cursor[i]].Key == Key;
+            if (!Present) break;
+            Chunk[i] = &Containers[Cursor[i]];
+            AllBitmaps = AllBitmaps && Chunk[i]->Cardinality > INDEX_ARRAY_MAX;
+            if (Chunk[i]->Cardinality < Chunk[Smallest]->Cardinality) Smallest = i;
+        }
+        if (!Present) continue;
+
+        uint64_t Base = (uint64_t)Key * INDEX_CHUNK;
+        if (AllBitmaps) {
+            const Words *In[BOARD_CELLS];
+            for (int i = 0; i < Count; ++i) In[i] = (const Words *)(ix->Map + Chunk[i]->DataOffset);
+            Intersect(Scratch, In, Count);
+            const uint64_t *Bits = (const uint64_t *)Scratch;
+            for (int w = 0; w < INDEX_BITMAP_WORDS; ++w) {
+                for (uint64_t x = Bits[w]; x; x &= x - 1) {
+                    Matches++;
+                    if (!match(context, Base + (uint64_t)w * 64 + (uint64_t)__builtin_ctzll(x))) return Matches;
+                }
+            }
+            continue;
+        }
+
+        // The smallest container is an array: test each of its members against the others
+        const uint16_t *Array = (const uint16_t *)(ix->Map + Chunk[Smallest]->DataOffset);
+        for (uint32_t k = 0; k < Chunk[Smallest]->Cardinality; ++k) {
+            bool All = true;
+            for (int i = 0; All && i < Count; ++i) {
+                if (i != Smallest) All = ContainerHas(ix, Chunk[i], Array[k]);
+            }
+            if (All) {
+                Matches++;
+                if (!match(context, Base + Array[k])) return Matches;
+            }
+        }
+    }
+    return Matches;
+}
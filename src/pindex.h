@@ -0,0 +1,68 @@
+#ifndef PINDEX_H
+#define PINDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+
+// NOTE: Pattern Index Layout (little-endian, read in place through mmap)
+//
+//   Header     : INDEX_HEADER_SIZE bytes (magic, version, byte order tag, entry count, directory offset)
+//   Data       : the containers of every posting list, bitmaps aligned to INDEX_ALIGN bytes
+//   Containers : per list, one IndexContainer per chunk of INDEX_CHUNK entries that has any member
+//   Directory  : INDEX_LISTS x IndexList, list (cell * 9 + digit - 1) holds the entries with that digit in that cell
+//
+// Entry n is line n of the catalog; the last 81 symbol field of each line is indexed, so plain batch output
+// and "PUZZLE SOLUTION" lines both work. A container is a sorted array of the low 16 bits of its entries
+// when it has at most INDEX_ARRAY_MAX of them and a bitmap of INDEX_CHUNK bits otherwise.
+#define INDEX_MAGIC "SDKI"
+#define INDEX_VERSION 1
+#define INDEX_BYTE_ORDER 0x01020304u
+#define INDEX_HEADER_SIZE 64
+#define INDEX_ALIGN 64
+#define INDEX_CHUNK 65536
+#define INDEX_ARRAY_MAX 4096
+#define INDEX_BITMAP_WORDS (INDEX_CHUNK / 64)
+#define INDEX_LISTS (BOARD_CELLS * BOARD_COLS)
+
+typedef struct {
+    char Magic[4];
+    uint32_t Version;
+    uint32_t ByteOrder;
+    uint32_t Lists;
+    uint64_t Entries;
+    uint64_t DirectoryOffset;
+    uint8_t Reserved[INDEX_HEADER_SIZE - 32];
+} IndexHeader;
+
+typedef struct {
+    uint64_t DataOffset;    // Sorted uint16 array or INDEX_BITMAP_WORDS uint64 words
+    uint32_t Key;           // Chunk number (entry / INDEX_CHUNK)
+    uint32_t Cardinality;
+} IndexContainer;
+
+typedef struct {
+    uint64_t ContainerOffset;
+    uint64_t Cardinality;   // Entries in the list
+    uint32_t ContainerCount;
+    uint32_t Reserved;
+} IndexList;
+
+typedef struct {
+    const uint8_t *Map;
+    size_t Size;
+    uint64_t Entries;
+    const IndexList *Lists;
+} PatternIndex;
+
+// Called once per matching entry in ascending order; return false to stop the query
+typedef bool (*MatchCallback)(void *context, uint64_t entry);
+
+const char *IndexKernelName(void);
+bool BuildPatternIndex(const char *catalog_path, const char *index_path);
+bool OpenPatternIndex(const char *path, PatternIndex *ix);
+void ClosePatternIndex(PatternIndex *ix);
+uint64_t QueryPatternIndex(const PatternIndex *ix, const int Pattern[BOARD_CELLS], MatchCallback match, void *context);
+
+#endif // PINDEX_H
@@ -0,0 +1,183 @@
+#include <pthread.h>
+#include "portfolio.h"
+#include "sat.h"
+
+typedef enum {
+    RUN_ABORTED = -1,   // Stopped by the stop flag or the restart budget
+    RUN_EXHAUSTED = 0,  // Whole tree searched, no solution
+    RUN_SOLVED = 1,
+} RunResult;
+
+typedef struct {
+    MaskBoard Board;
+    PortfolioMember Member;
+    int Id;
+    uint64_t Rng;
+    uint64_t Nodes;
+    uint64_t Budget;        // Node limit of the current run (UINT64_MAX when not restarting)
+    int *Stop;              // Shared: set once any member has finished
+    int *Winner;            // Shared: Id of the first member to finish
+    bool Solved;
+    pthread_t Thread;
+} Worker;
+
+// NOTE: Function that returns a printable name for a Strategy
+const char *StrategyName(SearchStrategy s) {
+    switch (s) {
+    case STRATEGY_ROW_MAJOR: return "row-major";
+    case STRATEGY_MRV: return "mrv";
+    case STRATEGY_RANDOM: return "random";
+    case STRATEGY_RESTART: return "restart";
+    }
+    return "unknown";
+}
+
+// NOTE: Function that fills members with the default mix: row-major, MRV, then random and restart with distinct seeds
+int DefaultPortfolio(PortfolioMember *members, int count) {
+    if (count > PORTFOLIO_MAX) count = PORTFOLIO_MAX;
+    for (int i = 0; i < count; ++i) {
+        members[i].Seed = 0x9E3779B97F4A7C15ull * (uint64_t)(i + 1);
+        if (i == 0) members[i].Strategy = STRATEGY_ROW_MAJOR;
+        else if (i == 1) members[i].Strategy = STRATEGY_MRV;
+        else members[i].Strategy = (i % 2 == 0) ? STRATEGY_RANDOM : STRATEGY_RESTART;
+    }
+    return count;
+}
+
+static uint64_t NextRandom(uint64_t *State) {
+    uint64_t x = *State;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *State = x;
+}
+
+// NOTE: Depth-first search over the Worker's Board using its Strategy for cell and digit order
+static RunResult Explore(Worker *w) {
+    if (++w->Nodes % PORTFOLIO_CHECK_INTERVAL == 0 && __atomic_load_n(w->Stop, __ATOMIC_RELAXED)) {
+        return RUN_ABORTED;
+    }
+    if (w->Nodes > w->Budget) {
+        return RUN_ABORTED;
+    }
+
+    MaskBoard *b = &w->Board;
+    uint16_t BestCandidates = 0;
+    int Best = PickFewestCandidates(b->Values, MaskBoardCandidates, b, w->Member.Strategy == STRATEGY_ROW_MAJOR, &BestCandidates);
+    if (Best == CELL_DEAD_END) {
+        return RUN_EXHAUSTED;
+    }
+    if (Best == CELL_NONE) {
+        return RUN_SOLVED;
+    }
+
+    int Digits[BOARD_COLS];
+    int Count = 0;
+    while (BestCandidates) {
+        Digits[Count++] = __builtin_ctz(BestCandidates) + 1;
+        BestCandidates &= (uint16_t)(BestCandidates - 1);
+    }
+    if (w->Member.Strategy == STRATEGY_RANDOM || w->Member.Strategy == STRATEGY_RESTART) {
+        for (int i = Count - 1; i > 0; --i) {
+            int j = (int)(NextRandom(&w->Rng) % (uint64_t)(i + 1));
+            int Tmp = Digits[i];
+            Digits[i] = Digits[j];
+            Digits[j] = Tmp;
+        }
+    }
+
+    for (int i = 0; i < Count; ++i) {
+        MaskPlace(b, Best, Digits[i]);
+        RunResult Result = Explore(w);
+        if (Result != RUN_EXHAUSTED) {
+            return Result;
+        }
+        MaskClear(b, Best);
+    }
+    return RUN_EXHAUSTED;
+}
+
+// NOTE: Thread Entry: run the member until it finishes or is told to stop, then try to claim the win
+static void *RunWorker(void *arg) {
+    Worker *w = (Worker *)arg;
+    MaskBoard Initial = w->Board;
+    RunResult Result;
+    uint64_t Restart = 0;
+
+    for (;;) {
+        if (w->Member.Strategy == STRATEGY_RESTART) {
+            w->Budget = w->Nodes + Luby(Restart++) * PORTFOLIO_RESTART_BASE;
+        }
+        Result = Explore(w);
+        bool OutOfBudget = Result == RUN_ABORTED && !__atomic_load_n(w->Stop, __ATOMIC_RELAXED);
+        if (!OutOfBudget) break;
+        w->Board = Initial;
+    }
+
+    if (Result != RUN_ABORTED) {
+        int Expected = -1;
+        if (__atomic_compare_exchange_n(w->Winner, &Expected, w->Id, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            w->Solved = Result == RUN_SOLVED;
+        }
+        __atomic_store_n(w->Stop, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+// NOTE: Function that races the members on one thread each and keeps the first result
+// On success Values is overwritten with the winner's solution; on failure it is left untouched.
+bool PortfolioSolveValues(int Values[BOARD_CELLS], const PortfolioMember *members, int count, PortfolioResult *result) {
+    memset(result, 0, sizeof(*result));
+    result->Winner = -1;
+    if (count < 1 || count > PORTFOLIO_MAX) {
+        fprintf(stderr, "ERROR: Portfolio needs between 1 and %d members\n", PORTFOLIO_MAX);
+        return false;
+    }
+
+    MaskBoard Initial;
+    if (!MaskBoardInit(&Initial, Values)) {
+        return false;
+    }
+
+    Worker *Workers = (Worker *)calloc((size_t)count, sizeof(Worker));
+    if (Workers == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        return false;
+    }
+    int Stop = 0;
+    int Winner = -1;
+    int Started = 0;
+    for (int i = 0; i < count; ++i) {
+        Worker *w = &Workers[i];
+        w->Board = Initial;
+        w->Member = members[i];
+        w->Id = i;
+        w->Rng = members[i].Seed ? members[i].Seed : 1;
+        w->Budget = UINT64_MAX;
+        w->Stop = &Stop;
+        w->Winner = &Winner;
+        if (pthread_create(&w->Thread, NULL, RunWorker, w) != 0) {
+            fprintf(stderr, "ERROR: Failed To Start Portfolio Thread %d\n", i);
+            break;
+        }
+        Started++;
+    }
+    if (Started == 0) {
+        free(Workers);
+        return false;
+    }
+    for (int i = 0; i < Started; ++i) {
+        pthread_join(Workers[i].Thread, NULL);
+        result->Nodes[i] = Workers[i].Nodes;
+    }
+
+    result->Winner = Winner;
+    if (Winner >= 0) {
+        result->Solved = Workers[Winner].Solved;
+        if (result->Solved) {
+            memcpy(Values, Workers[Winner].Board.Values, sizeof(int) * BOARD_CELLS);
+        }
+    }
+    free(Workers);
+    return result->Solved;
+}
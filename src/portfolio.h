@@ -0,0 +1,39 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+#include "masks.h"
+
+// NOTE: Portfolio Solving
+// Several differently configured searches race on their own thread; the first one to finish (with a solution
+// or with a proof that there is none) wins and the others notice the shared stop flag and return early.
+#define PORTFOLIO_MAX 16
+#define PORTFOLIO_DEFAULT 4
+#define PORTFOLIO_CHECK_INTERVAL 256    // Nodes between two looks at the stop flag
+#define PORTFOLIO_RESTART_BASE 256      // Node budget of the first restart, scaled by the Luby sequence
+
+typedef enum {
+    STRATEGY_ROW_MAJOR,     // First Empty cell in row-major order, digits ascending (same order as Search)
+    STRATEGY_MRV,           // Cell with the fewest candidates, digits ascending
+    STRATEGY_RANDOM,        // Cell with the fewest candidates, digits in a seeded random order
+    STRATEGY_RESTART,       // Like STRATEGY_RANDOM, restarting with a fresh order whenever its node budget runs out
+} SearchStrategy;
+
+typedef struct {
+    SearchStrategy Strategy;
+    uint64_t Seed;
+} PortfolioMember;
+
+typedef struct {
+    int Winner;             // Index of the member that finished first, -1 if none did
+    bool Solved;            // Whether the winner found a solution (false means the puzzle has none)
+    uint64_t Nodes[PORTFOLIO_MAX];   // Search nodes visited by each member before it stopped
+} PortfolioResult;
+
+const char *StrategyName(SearchStrategy s);
+int DefaultPortfolio(PortfolioMember *members, int count);
+bool PortfolioSolveValues(int Values[BOARD_CELLS], const PortfolioMember *members, int count, PortfolioResult *result);
+
+#endif // PORTFOLIO_H
@@ -0,0 +1,484 @@
+#include "sat.h"
+
+// NOTE: Literals are 2 * Var + Sign, so Lit ^ 1 is the negation
+#define LIT(var, neg) (2 * (var) + (neg))
+#define VAR(lit) ((lit) >> 1)
+#define NO_REASON -1
+
+// Clause Arena Layout: [Size, Lit0, Lit1, ...], a Clause is referenced by its offset in the Arena
+#define CLAUSE_SIZE(s, cr) ((s)->Arena.items[(cr)])
+#define CLAUSE_LITS(s, cr) ((s)->Arena.items + (cr) + 1)
+
+typedef enum {
+    VALUE_FALSE = 0,
+    VALUE_TRUE = 1,
+    VALUE_UNDEF = 2,
+} LitValue;
+
+typedef struct {
+    int *items;
+    size_t count;
+    size_t capacity;
+} IntVec;
+
+typedef struct {
+    int VarCount;
+    IntVec Arena;          // All Clauses, original and learnt
+    IntVec *Watches;       // Per Literal: Clauses that currently watch it
+    uint8_t *Assign;       // Per Var: VALUE_* of the positive literal
+    uint8_t *Phase;        // Per Var: last assigned Sign (phase saving)
+    int *Level;            // Per Var: Decision Level it was assigned at
+    int *Reason;           // Per Var: Clause that implied it, or NO_REASON
+    char *Seen;            // Per Var: scratch flag for Conflict Analysis
+    int *Trail;            // Assigned Literals in order
+    int TrailCount;
+    int QueueHead;         // Next Trail entry to propagate
+    IntVec TrailLimits;    // Trail position where each Decision Level starts
+    double *Activity;      // VSIDS Scores
+    double ActivityInc;
+    int *Heap;             // Binary max-heap of Vars ordered by Activity
+    int *HeapIndex;        // Position of each Var in Heap, -1 if absent
+    int HeapCount;
+    IntVec Learnt;         // Scratch Clause built by Conflict Analysis
+    SatStats Stats;
+} SatSolver;
+
+static bool VecPush(IntVec *v, int x) {
+    if (v->count == v->capacity) {
+        size_t Capacity = v->capacity ? v->capacity * 2 : 4;
+        int *Grown = (int *)realloc(v->items, sizeof(int) * Capacity);
+        if (Grown == NULL) {
+            return false;
+        }
+        v->items = Grown;
+        v->capacity = Capacity;
+    }
+    v->items[v->count++] = x;
+    return true;
+}
+
+static inline LitValue ValueOf(const SatSolver *s, int lit) {
+    uint8_t a = s->Assign[VAR(lit)];
+    return a == VALUE_UNDEF ? VALUE_UNDEF : (LitValue)(a ^ (lit & 1));
+}
+
+static inline int DecisionLevel(const SatSolver *s) {
+    return (int)s->TrailLimits.count;
+}
+
+// NOTE: VSIDS Heap Helpers
+static void HeapSwap(SatSolver *s, int i, int j) {
+    int a = s->Heap[i], b = s->Heap[j];
+    s->Heap[i] = b; s->HeapIndex[b] = i;
+    s->Heap[j] = a; s->HeapIndex[a] = j;
+}
+
+static void HeapUp(SatSolver *s, int i) {
+    while (i > 0) {
+        int Parent = (i - 1) / 2;
+        if (s->Activity[s->Heap[Parent]] >= s->Activity[s->Heap[i]]) break;
+        HeapSwap(s, i, Parent);
+        i = Parent;
+    }
+}
+
+static void HeapDown(SatSolver *s, int i) {
+    for (;;) {
+        int Left = 2 * i + 1, Right = Left + 1, Best = i;
+        if (Left < s->HeapCount && s->Activity[s->Heap[Left]] > s->Activity[s->Heap[Best]]) Best = Left;
+        if (Right < s->HeapCount && s->Activity[s->Heap[Right]] > s->Activity[s->Heap[Best]]) Best = Right;
+        if (Best == i) break;
+        HeapSwap(s, i, Best);
+        i = Best;
+    }
+}
+
+static void HeapInsert(SatSolver *s, int var) {
+    if (s->HeapIndex[var] >= 0) return;
+    s->Heap[s->HeapCount] = var;
+    s->HeapIndex[var] = s->HeapCount++;
+    HeapUp(s, s->HeapIndex[var]);
+}
+
+static int HeapPop(SatSolver *s) {
+    int Top = s->Heap[0];
+    s->HeapIndex[Top] = -1;
+    if (--s->HeapCount > 0) {
+        s->Heap[0] = s->Heap[s->HeapCount];
+        s->HeapIndex[s->Heap[0]] = 0;
+        HeapDown(s, 0);
+    }
+    return Top;
+}
+
+static void BumpActivity(SatSolver *s, int var) {
+    s->Activity[var] += s->ActivityInc;
+    if (s->Activity[var] > 1e100) {
+        for (int v = 0; v < s->VarCount; ++v) s->Activity[v] *= 1e-100;
+        s->ActivityInc *= 1e-100;
+    }
+    if (s->HeapIndex[var] >= 0) HeapUp(s, s->HeapIndex[var]);
+}
+
+// NOTE: Function that allocates a Solver for VarCount variables
+static bool SolverInit(SatSolver *s, int var_count) {
+    memset(s, 0, sizeof(*s));
+    s->VarCount = var_count;
+    s->ActivityInc = 1.0;
+    s->Watches = (IntVec *)calloc((size_t)var_count * 2, sizeof(IntVec));
+    s->Assign = (uint8_t *)malloc((size_t)var_count);
+    s->Phase = (uint8_t *)calloc((size_t)var_count, 1);
+    s->Level = (int *)calloc((size_t)var_count, sizeof(int));
+    s->Reason = (int *)malloc(sizeof(int) * var_count);
+    s->Seen = (char *)calloc((size_t)var_count, 1);
+    s->Trail = (int *)malloc(sizeof(int) * var_count);
+    s->Activity = (double *)calloc((size_t)var_count, sizeof(double));
+    s->Heap = (int *)malloc(sizeof(int) * var_count);
+    s->HeapIndex = (int *)malloc(sizeof(int) * var_count);
+    if (!s->Watches || !s->Assign || !s->Phase || !s->Level || !s->Reason || !s->Seen
+        || !s->Trail || !s->Activity || !s->Heap || !s->HeapIndex) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        return false;
+    }
+    memset(s->Assign, VALUE_UNDEF, (size_t)var_count);
+    for (int v = 0; v < var_count; ++v) {
+        s->Reason[v] = NO_REASON;
+        s->HeapIndex[v] = -1;
+        HeapInsert(s, v);
+    }
+    return true;
+}
+
+static void SolverFree(SatSolver *s) {
+    if (s->Watches != NULL) {
+        for (int l = 0; l < 2 * s->VarCount; ++l) free(s->Watches[l].items);
+    }
+    free(s->Watches);
+    free(s->Arena.items);
+    free(s->Assign);
+    free(s->Phase);
+    free(s->Level);
+    free(s->Reason);
+    free(s->Seen);
+    free(s->Trail);
+    free(s->TrailLimits.items);
+    free(s->Activity);
+    free(s->Heap);
+    free(s->HeapIndex);
+    free(s->Learnt.items);
+}
+
+static void Enqueue(SatSolver *s, int lit, int reason) {
+    int v = VAR(lit);
+    s->Assign[v] = (uint8_t)(VALUE_TRUE ^ (lit & 1));
+    s->Level[v] = DecisionLevel(s);
+    s->Reason[v] = reason;
+    s->Trail[s->TrailCount++] = lit;
+}
+
+// NOTE: Function that stores a Clause in the Arena and watches its first two literals
+static int AttachClause(SatSolver *s, const int *lits, int size) {
+    int cr = (int)s->Arena.count;
+    bool Ok = VecPush(&s->Arena, size);
+    for (int i = 0; Ok && i < size; ++i) Ok = VecPush(&s->Arena, lits[i]);
+    Ok = Ok && VecPush(&s->Watches[lits[0]], cr) && VecPush(&s->Watches[lits[1]], cr);
+    if (!Ok) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        return -1;
+    }
+    return cr;
+}
+
+// NOTE: Function that adds an original Clause at Decision Level 0, returns false if the formula became UNSAT
+static bool AddClause(SatSolver *s, const int *lits, int size) {
+    if (size == 1) {
+        LitValue Value = ValueOf(s, lits[0]);
+        if (Value == VALUE_UNDEF) Enqueue(s, lits[0], NO_REASON);
+        return Value != VALUE_FALSE;
+    }
+    return AttachClause(s, lits, size) >= 0;
+}
+
+// NOTE: Function that propagates the Trail, returns the conflicting Clause or NO_REASON
+static int Propagate(SatSolver *s) {
+    while (s->QueueHead < s->TrailCount) {
+        int FalseLit = s->Trail[s->QueueHead++] ^ 1;
+        IntVec *Watch = &s->Watches[FalseLit];
+        size_t i = 0, j = 0;
+        s->Stats.Propagations++;
+
+        while (i < Watch->count) {
+            int cr = Watch->items[i++];
+            int *Lits = CLAUSE_LITS(s, cr);
+            int Size = CLAUSE_SIZE(s, cr);
+
+            // Make sure the false literal is Lits[1]
+            if (Lits[0] == FalseLit) {
+                Lits[0] = Lits[1];
+                Lits[1] = FalseLit;
+            }
+            if (ValueOf(s, Lits[0]) == VALUE_TRUE) {
+                Watch->items[j++] = cr;
+                continue;
+            }
+
+            // Look for a new literal to watch
+            bool Moved = false;
+            for (int k = 2; k < Size; ++k) {
+                if (ValueOf(s, Lits[k]) != VALUE_FALSE) {
+                    Lits[1] = Lits[k];
+                    Lits[k] = FalseLit;
+                    VecPush(&s->Watches[Lits[1]], cr);
+                    Moved = true;
+                    break;
+                }
+            }
+            if (Moved) continue;
+
+            // Clause is unit or conflicting
+            Watch->items[j++] = cr;
+            if (ValueOf(s, Lits[0]) == VALUE_FALSE) {
+                while (i < Watch->count) Watch->items[j++] = Watch->items[i++];
+                Watch->count = j;
+                s->QueueHead = s->TrailCount;
+                return cr;
+            }
+            Enqueue(s, Lits[0], cr);
+        }
+        Watch->count = j;
+    }
+    return NO_REASON;
+}
+
+// NOTE: Function that undoes every assignment above the given Decision Level
+static void Backtrack(SatSolver *s, int level) {
+    if (DecisionLevel(s) <= level) return;
+    int Limit = s->TrailLimits.items[level];
+    for (int i = s->TrailCount - 1; i >= Limit; --i) {
+        int v = VAR(s->Trail[i]);
+        s->Phase[v] = (uint8_t)(s->Trail[i] & 1);
+        s->Assign[v] = VALUE_UNDEF;
+        s->Reason[v] = NO_REASON;
+        HeapInsert(s, v);
+    }
+    s->TrailCount = Limit;
+    s->QueueHead = Limit;
+    s->TrailLimits.count = (size_t)level;
+}
+
+// NOTE: A literal of the learnt Clause is redundant if its Reason only contains literals already in the Clause
+static bool Redundant(const SatSolver *s, int lit) {
+    int cr = s->Reason[VAR(lit)];
+    if (cr == NO_REASON) return false;
+    const int *Lits = CLAUSE_LITS(s, cr);
+    for (int k = 1; k < CLAUSE_SIZE(s, cr); ++k) {
+        int v = VAR(Lits[k]);
+        if (!s->Seen[v] && s->Level[v] > 0) return false;
+    }
+    return true;
+}
+
+// NOTE: Function that derives the 1-UIP Clause from a conflict, returns the Backtrack Level
+static int Analyze(SatSolver *s, int conflict) {
+    IntVec *Learnt = &s->Learnt;
+    Learnt->count = 0;
+    VecPush(Learnt, 0); // Placeholder for the asserting literal
+
+    int PathCount = 0;
+    int Lit = -1;
+    int Index = s->TrailCount - 1;
+    int cr = conflict;
+    do {
+        const int *Lits = CLAUSE_LITS(s, cr);
+        for (int k = (Lit == -1) ? 0 : 1; k < CLAUSE_SIZE(s, cr); ++k) {
+            int v = VAR(Lits[k]);
+            if (!s->Seen[v] && s->Level[v] > 0) {
+                s->Seen[v] = 1;
+                BumpActivity(s, v);
+                if (s->Level[v] >= DecisionLevel(s)) {
+                    PathCount++;
+                } else {
+                    VecPush(Learnt, Lits[k]);
+                }
+            }
+        }
+        while (!s->Seen[VAR(s->Trail[Index])]) Index--;
+        Lit = s->Trail[Index--];
+        cr = s->Reason[VAR(Lit)];
+        s->Seen[VAR(Lit)] = 0;
+        PathCount--;
+    } while (PathCount > 0);
+    Learnt->items[0] = Lit ^ 1;
+
+    // Drop literals implied by the rest of the Clause, then clear the scratch flags
+    // (redundant literals are marked by complementing them until every Seen flag has been cleared)
+    for (size_t i = 1; i < Learnt->count; ++i) {
+        if (Redundant(s, Learnt->items[i])) Learnt->items[i] = ~Learnt->items[i];
+    }
+    size_t Kept = 1;
+    for (size_t i = 1; i < Learnt->count; ++i) {
+        int Item = Learnt->items[i];
+        s->Seen[VAR(Item < 0 ? ~Item : Item)] = 0;
+        if (Item >= 0) Learnt->items[Kept++] = Item;
+    }
+    Learnt->count = Kept;
+
+    // Second watch goes on the literal with the highest level so the Clause is unit after Backtracking
+    int BacktrackLevel = 0;
+    for (size_t i = 1; i < Learnt->count; ++i) {
+        int Level = s->Level[VAR(Learnt->items[i])];
+        if (Level > BacktrackLevel) {
+            BacktrackLevel = Level;
+            int Tmp = Learnt->items[1];
+            Learnt->items[1] = Learnt->items[i];
+            Learnt->items[i] = Tmp;
+        }
+    }
+
+    s->ActivityInc *= 1.0 / 0.95;
+    return BacktrackLevel;
+}
+
+// NOTE: Luby Sequence 1 1 2 1 1 2 4 1 1 2 ... used to space out Restarts (also by the Portfolio)
+uint64_t Luby(uint64_t i) {
+    uint64_t Size = 1, Seq = 0;
+    while (Size < i + 1) {
+        Seq++;
+        Size = 2 * Size + 1;
+    }
+    while (Size - 1 != i) {
+        Size = (Size - 1) >> 1;
+        Seq--;
+        i = i % Size;
+    }
+    return (uint64_t)1 << Seq;
+}
+
+// NOTE: Main CDCL Loop, returns true if the formula is satisfiable
+static bool SolverRun(SatSolver *s) {
+    uint64_t RestartCount = 0;
+    uint64_t ConflictBudget = Luby(RestartCount) * SAT_RESTART_BASE;
+
+    for (;;) {
+        int Conflict = Propagate(s);
+        if (Conflict != NO_REASON) {
+            s->Stats.Conflicts++;
+            if (DecisionLevel(s) == 0) {
+                return false;
+            }
+            int Level = Analyze(s, Conflict);
+            Backtrack(s, Level);
+            if (s->Learnt.count == 1) {
+                Enqueue(s, s->Learnt.items[0], NO_REASON);
+            } else {
+                int cr = AttachClause(s, s->Learnt.items, (int)s->Learnt.count);
+                if (cr < 0) return false;
+                Enqueue(s, s->Learnt.items[0], cr);
+                s->Stats.Learnt++;
+            }
+            if (--ConflictBudget == 0) {
+                Backtrack(s, 0);
+                s->Stats.Restarts++;
+                ConflictBudget = Luby(++RestartCount) * SAT_RESTART_BASE;
+            }
+            continue;
+        }
+
+        // Pick the most active unassigned Var and try its saved phase
+        int Next = -1;
+        while (s->HeapCount > 0) {
+            int v = HeapPop(s);
+            if (s->Assign[v] == VALUE_UNDEF) {
+                Next = v;
+                break;
+            }
+        }
+        if (Next == -1) {
+            return true;
+        }
+        s->Stats.Decisions++;
+        VecPush(&s->TrailLimits, s->TrailCount);
+        Enqueue(s, LIT(Next, s->Phase[Next]), NO_REASON);
+    }
+}
+
+// NOTE: Function that adds "exactly one of lits" as one long Clause plus pairwise exclusions
+static bool ExactlyOne(SatSolver *s, const int *lits, int n) {
+    if (!AddClause(s, lits, n)) return false;
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            int Pair[2] = { lits[i] ^ 1, lits[j] ^ 1 };
+            if (!AddClause(s, Pair, 2)) return false;
+        }
+    }
+    return true;
+}
+
+// NOTE: Function that solves a board of box x box boxes with the CDCL backend
+// On success Values is overwritten with the solution; on failure it is left untouched.
+bool SatSolveValues(int *Values, int box, SatStats *stats) {
+    if (box < 2 || box > SAT_MAX_BOX) {
+        fprintf(stderr, "ERROR: Unsupported Box Size %d\n", box);
+        return false;
+    }
+    int N = box * box;
+    SatSolver s;
+    if (!SolverInit(&s, N * N * N)) {
+        SolverFree(&s);
+        return false;
+    }
+
+    // Variable (Row, Col, Digit) is true when the cell holds Digit + 1
+    #define CELL_VAR(r, c, d) (((r) * N + (c)) * N + (d))
+    int Lits[SAT_MAX_BOX * SAT_MAX_BOX];
+    bool Ok = true;
+    for (int r = 0; Ok && r < N; ++r) {
+        for (int c = 0; Ok && c < N; ++c) {
+            int Value = Values[r * N + c];
+            if (Value < 0 || Value > N) {
+                fprintf(stderr, "ERROR: Invalid Value %d at (%d, %d)\n", Value, r, c);
+                Ok = false;
+            } else if (Value != EMPTY) {
+                int Unit = LIT(CELL_VAR(r, c, Value - 1), 0);
+                Ok = AddClause(&s, &Unit, 1);
+            }
+        }
+    }
+    for (int a = 0; Ok && a < N; ++a) {
+        for (int b = 0; Ok && b < N; ++b) {
+            // Cell (a, b) holds one digit
+            for (int d = 0; d < N; ++d) Lits[d] = LIT(CELL_VAR(a, b, d), 0);
+            Ok = ExactlyOne(&s, Lits, N);
+            // Digit b appears once in Row a, once in Column a and once in Box a
+            for (int i = 0; Ok && i < N; ++i) Lits[i] = LIT(CELL_VAR(a, i, b), 0);
+            Ok = Ok && ExactlyOne(&s, Lits, N);
+            for (int i = 0; Ok && i < N; ++i) Lits[i] = LIT(CELL_VAR(i, a, b), 0);
+            Ok = Ok && ExactlyOne(&s, Lits, N);
+            for (int i = 0; Ok && i < N; ++i) {
+                Lits[i] = LIT(CELL_VAR((a / box) * box + i / box, (a % box) * box + i % box, b), 0);
+            }
+            Ok = Ok && ExactlyOne(&s, Lits, N);
+        }
+    }
+
+    bool Solved = Ok && SolverRun(&s);
+    if (Solved) {
+        for (int r = 0; r < N; ++r) {
+            for (int c = 0; c < N; ++c) {
+                for (int d = 0; d < N; ++d) {
+                    if (s.Assign[CELL_VAR(r, c, d)] == VALUE_TRUE) {
+                        Values[r * N + c] = d + 1;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    #undef CELL_VAR
+
+    if (stats != NULL) {
+        *stats = s.Stats;
+    }
+    SolverFree(&s);
+    return Solved;
+}
@@ -0,0 +1,27 @@
+#ifndef SAT_H
+#define SAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+
+// NOTE: CDCL SAT Backend
+// The board is encoded as CNF with one variable per (cell, digit) pair and exactly-one constraints on
+// every cell, row, column and box. The solver uses two watched literals, 1-UIP clause learning,
+// VSIDS branching with phase saving and Luby restarts. Boards of any box size up to SAT_MAX_BOX work,
+// values are stored flat in row-major order with 0 for Empty cells.
+#define SAT_MAX_BOX 5
+#define SAT_RESTART_BASE 100
+
+typedef struct {
+    uint64_t Conflicts;
+    uint64_t Decisions;
+    uint64_t Propagations;
+    uint64_t Restarts;
+    uint64_t Learnt;
+} SatStats;
+
+bool SatSolveValues(int *Values, int box, SatStats *stats);
+uint64_t Luby(uint64_t i);
+
+#endif // SAT_H
@@ -0,0 +1,432 @@
+#include <math.h>
+#include "schedule.h"
+#include "masks.h"
+#include "perf.h"
+
+const char *HardnessName(HardnessClass c) {
+    switch (c) {
+    case HARDNESS_EASY: return "easy";
+    case HARDNESS_MEDIUM: return "medium";
+    case HARDNESS_HARD: return "hard";
+    case HARDNESS_CLASSES: break;
+    }
+    return "unknown";
+}
+
+// NOTE: Function that places every hidden single of one unit, returns -1 on a contradiction
+static int HiddenSingles(MaskBoard *b, const int Cells[BOARD_COLS], uint16_t Placed) {
+    int Count = 0;
+    for (int d = 1; d <= BOARD_COLS; ++d) {
+        uint16_t Bit = (uint16_t)(1u << (d - 1));
+        if (Placed & Bit) continue;
+        int Where = -1, Seen = 0;
+        for (int i = 0; i < BOARD_COLS && Seen < 2; ++i) {
+            if (b->Values[Cells[i]] == EMPTY && (MaskCandidates(b, Cells[i]) & Bit)) {
+                Where = Cells[i];
+                Seen++;
+            }
+        }
+        if (Seen == 0) return -1;
+        if (Seen == 1) {
+            MaskPlace(b, Where, d);
+            Placed |= Bit;
+            Count++;
+        }
+    }
+    return Count;
+}
+
+// NOTE: Function that estimates how hard a puzzle is from what naked and hidden singles leave behind
+Hardness EstimateHardness(const int Values[BOARD_CELLS]) {
+    Hardness h;
+    h.Clues = 0;
+    for (int c = 0; c < BOARD_CELLS; ++c) h.Clues += Values[c] != EMPTY;
+    h.Residue = 0;
+    h.Entropy = 0.0;
+    h.Score = h.Clues < LOW_CLUES ? CLUE_WEIGHT * (LOW_CLUES - h.Clues) : 0.0;
+    h.Class = h.Score >= HARD_SCORE ? HARDNESS_HARD : HARDNESS_EASY;
+
+    MaskBoard b;
+    if (!MaskBoardInit(&b, Values)) {
+        return h;   // Contradicting givens fail immediately
+    }
+
+    bool Changed = true;
+    while (Changed) {
+        Changed = false;
+        for (int c = 0; c < BOARD_CELLS; ++c) {
+            if (b.Values[c] != EMPTY) continue;
+            uint16_t Candidates = MaskCandidates(&b, c);
+            if (Candidates == 0) return h;
+            if ((Candidates & (Candidates - 1)) == 0) {
+                MaskPlace(&b, c, __builtin_ctz(Candidates) + 1);
+                Changed = true;
+            }
+        }
+        for (int u = 0; u < BOARD_ROWS; ++u) {
+            int Row[BOARD_COLS], Col[BOARD_COLS], Box[BOARD_COLS];
+            for (int i = 0; i < BOARD_COLS; ++i) {
+                Row[i] = u * BOARD_COLS + i;
+                Col[i] = i * BOARD_COLS + u;
+                Box[i] = ((u / 3) * 3 + i / 3) * BOARD_COLS + (u % 3) * 3 + i % 3;
+            }
+            int Found[3] = {
+                HiddenSingles(&b, Row, b.Row[u]),
+                HiddenSingles(&b, Col, b.Col[u]),
+                HiddenSingles(&b, Box, b.Box[u]),
+            };
+            for (int i = 0; i < 3; ++i) {
+                if (Found[i] < 0) return h;
+                if (Found[i] > 0) Changed = true;
+            }
+        }
+    }
+
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        if (b.Values[c] != EMPTY) continue;
+        h.Residue++;
+        h.Entropy += log2((double)__builtin_popcount(MaskCandidates(&b, c)));
+    }
+    h.Score += h.Entropy;
+    if (h.Score >= HARD_SCORE) {
+        h.Class = HARDNESS_HARD;
+    } else if (h.Residue > 0) {
+        h.Class = HARDNESS_MEDIUM;
+    }
+    return h;
+}
+
+static void RecordLatency(LatencyHistogram *h, double micros) {
+    int Bucket = micros < 1.0 ? 0 : (int)(4.0 * log2(micros));
+    if (Bucket >= LATENCY_BUCKETS) Bucket = LATENCY_BUCKETS - 1;
+    h->Count[Bucket]++;
+    h->Puzzles++;
+    h->TotalMicros += micros;
+    if (micros > h->MaxMicros) h->MaxMicros = micros;
+}
+
+// NOTE: Function that returns the upper bound of the bucket holding the p-th fraction of the latencies
+double LatencyPercentile(const LatencyHistogram *h, double p) {
+    uint64_t Target = (uint64_t)ceil(p * (double)h->Puzzles);
+    if (Target == 0) Target = 1;
+    uint64_t Seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+        Seen += h->Count[i];
+        if (Seen >= Target) {
+            double Bound = exp2((double)(i + 1) / 4.0);
+            return Bound < h->MaxMicros ? Bound : h->MaxMicros;
+        }
+    }
+    return h->MaxMicros;
+}
+
+// Boards taken by one thread at once, all from the same batch
+typedef struct {
+    ScheduleBatch *Batch;
+    int Index[SCHEDULE_MAX_GROUP];
+    int Count;
+    bool Hard;
+} Group;
+
+// NOTE: Function that appends up to GroupSize boards of a start order list to g, starting at *next
+// With hardness ordering the group ends where the class changes; FIFO groups are consecutive input boards.
+static void TakeGroup(Scheduler *s, ScheduleBatch *b, const int *order, int count, int *next, Group *g) {
+    HardnessClass First = b->Classes[order[*next]];
+    while (*next < count && g->Count < s->GroupSize) {
+        if (s->Config.HardFirst && b->Classes[order[*next]] != First) break;
+        g->Index[g->Count++] = order[(*next)++];
+    }
+    g->Batch = b;
+}
+
+// NOTE: Function that returns whether any pending batch still has boards other than hard ones to start
+static bool EasierWaiting(const Scheduler *s) {
+    for (int i = 0; i < s->PendingCount; ++i) {
+        if (s->Pending[i]->NextRest < s->Pending[i]->RestCount) return true;
+    }
+    return false;
+}
+
+// NOTE: Function that picks the next group (called with the Lock held): hard boards of the oldest batch while under
+// the cap, otherwise the next easier ones of the oldest batch that has any, and hard boards past the cap only
+// once nothing else is left in any batch. Returns false when there is nothing to start.
+static bool NextGroup(Scheduler *s, Group *g) {
+    g->Count = 0;
+    if (s->Stopping) {
+        return false;
+    }
+    bool UnderCap = s->Config.MaxHard <= 0 || s->RunningHard < s->Config.MaxHard;
+    for (int i = 0; i < s->PendingCount; ++i) {
+        ScheduleBatch *b = s->Pending[i];
+        if (UnderCap && b->NextHard < b->HardCount) {
+            g->Hard = true;
+            TakeGroup(s, b, b->Hard, b->HardCount, &b->NextHard, g);
+        } else if (b->NextRest < b->RestCount) {
+            g->Hard = false;
+            TakeGroup(s, b, b->Rest, b->RestCount, &b->NextRest, g);
+        }
+        if (g->Count > 0) break;
+    }
+    for (int i = 0; g->Count == 0 && i < s->PendingCount; ++i) {
+        ScheduleBatch *b = s->Pending[i];
+        if (b->NextHard < b->HardCount) {
+            g->Hard = true;
+            TakeGroup(s, b, b->Hard, b->HardCount, &b->NextHard, g);
+        }
+    }
+    if (g->Count == 0) {
+        return false;
+    }
+    if (g->Hard) {
+        s->RunningHard++;
+        if (s->RunningHard > s->PeakHard && EasierWaiting(s)) s->PeakHard = s->RunningHard;
+    }
+    ScheduleBatch *b = g->Batch;
+    b->Groups++;
+    for (int i = 1; i < g->Count; ++i) {
+        if (b->Classes[g->Index[i]] != b->Classes[g->Index[0]]) {
+            b->MixedGroups++;
+            break;
+        }
+    }
+    return true;
+}
+
+// NOTE: Thread Entry: solve groups until the pool stops; a group is copied into one contiguous block for Solve
+static void *RunScheduleWorker(void *arg) {
+    Scheduler *s = (Scheduler *)arg;
+    int Values[SCHEDULE_MAX_GROUP * BOARD_CELLS];
+    bool Solved[SCHEDULE_MAX_GROUP];
+    Group g;
+
+    pthread_mutex_lock(&s->Lock);
+    for (;;) {
+        while (!NextGroup(s, &g)) {
+            if (s->Stopping) {
+                pthread_mutex_unlock(&s->Lock);
+                return NULL;
+            }
+            pthread_cond_wait(&s->Work, &s->Lock);
+        }
+        pthread_mutex_unlock(&s->Lock);
+
+        ScheduleBatch *b = g.Batch;
+        BatchStats Stats = { 0, 0, 0 };
+        for (int i = 0; i < g.Count; ++i) {
+            memcpy(Values + i * BOARD_CELLS, b->Values + g.Index[i] * BOARD_CELLS, sizeof(int) * BOARD_CELLS);
+        }
+        s->Solve(s->Context, Values, g.Count, Solved, &Stats);
+        double Done = Now();
+        for (int i = 0; i < g.Count; ++i) {
+            memcpy(b->Values + g.Index[i] * BOARD_CELLS, Values + i * BOARD_CELLS, sizeof(int) * BOARD_CELLS);
+            b->Solved[g.Index[i]] = Solved[i];
+            b->Done[g.Index[i]] = Done;
+        }
+
+        pthread_mutex_lock(&s->Lock);
+        b->Batch.Propagated += Stats.Propagated;
+        b->Batch.Branched += Stats.Branched;
+        b->Batch.Contradicted += Stats.Contradicted;
+        if (g.Hard) s->RunningHard--;
+        b->Remaining -= g.Count;
+        if (b->Remaining == 0) {
+            pthread_cond_broadcast(&s->Finished);
+        }
+        if (g.Hard) {
+            pthread_cond_broadcast(&s->Work);   // Hard boards held back by the cap may start now
+        }
+    }
+}
+
+// NOTE: Function that starts config->Workers solver threads, returns false if none could be started
+bool SchedulerStart(Scheduler *s, const ScheduleConfig *config, int group_size, SolveFunction solve, void *context) {
+    memset(s, 0, sizeof(*s));
+    s->Config = *config;
+    s->GroupSize = group_size < 1 ? 1 : group_size > SCHEDULE_MAX_GROUP ? SCHEDULE_MAX_GROUP : group_size;
+    s->Solve = solve;
+    s->Context = context;
+    pthread_mutex_init(&s->Lock, NULL);
+    pthread_cond_init(&s->Work, NULL);
+    pthread_cond_init(&s->Finished, NULL);
+
+    int Workers = config->Workers < 1 ? 1 : config->Workers > SCHEDULE_MAX_WORKERS ? SCHEDULE_MAX_WORKERS : config->Workers;
+    for (int i = 0; i < Workers; ++i) {
+        if (pthread_create(&s->Threads[i], NULL, RunScheduleWorker, s) != 0) break;
+        s->Started++;
+    }
+    if (s->Started == 0) {
+        SchedulerStop(s);
+        return false;
+    }
+    return true;
+}
+
+// Start order entry: higher Score first
+typedef struct {
+    double Score;
+    int Index;
+} Ranked;
+
+static int ByHardness(const void *a, const void *b) {
+    double x = ((const Ranked *)a)->Score, y = ((const Ranked *)b)->Score;
+    return (x < y) - (x > y);
+}
+
+// NOTE: Function that sorts the indices by descending Score through a scratch array of Ranked entries
+static void SortByHardness(int *indices, int count, const Hardness *estimates, Ranked *scratch) {
+    for (int i = 0; i < count; ++i) {
+        scratch[i].Score = estimates[indices[i]].Score;
+        scratch[i].Index = indices[i];
+    }
+    qsort(scratch, (size_t)count, sizeof(Ranked), ByHardness);
+    for (int i = 0; i < count; ++i) indices[i] = scratch[i].Index;
+}
+
+// NOTE: Function that moves the medium boards in front of the easy ones, keeping each in its sorted order,
+// so that groups of the easier boards do not mix classes
+static void GroupByClass(int *indices, int count, const HardnessClass *classes, Ranked *scratch) {
+    int n = 0;
+    for (int c = HARDNESS_HARD; c >= HARDNESS_EASY; --c) {
+        for (int i = 0; i < count; ++i) {
+            if (classes[indices[i]] == (HardnessClass)c) scratch[n++].Index = indices[i];
+        }
+    }
+    for (int i = 0; i < count; ++i) indices[i] = scratch[i].Index;
+}
+
+// NOTE: Function that queues count 9x9 boards of Values to be solved in place; Values and Solved must stay valid
+// until SchedulerWait returns for b. Solved[i] always belongs to board i, whatever order the boards start in.
+// At most SCHEDULE_WINDOW batches may be submitted and not yet waited for.
+bool SchedulerSubmit(Scheduler *s, ScheduleBatch *b, int *Values, int count, bool *Solved) {
+    memset(b, 0, sizeof(*b));
+    b->Values = Values;
+    b->Solved = Solved;
+    b->Count = count;
+    b->Start = Now();
+    if (count <= 0) {
+        return true;
+    }
+
+    Hardness *Estimates = (Hardness *)malloc(sizeof(Hardness) * count);
+    Ranked *Scratch = (Ranked *)malloc(sizeof(Ranked) * count);
+    b->Classes = (HardnessClass *)malloc(sizeof(HardnessClass) * count);
+    b->Hard = (int *)malloc(sizeof(int) * count * 2);
+    b->Done = (double *)malloc(sizeof(double) * count);
+    if (Estimates == NULL || Scratch == NULL || b->Classes == NULL || b->Hard == NULL || b->Done == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        free(Estimates);
+        free(Scratch);
+        free(b->Classes);
+        free(b->Hard);
+        free(b->Done);
+        memset(b, 0, sizeof(*b));
+        return false;
+    }
+
+    b->Rest = b->Hard + count;
+    for (int i = 0; i < count; ++i) {
+        Estimates[i] = EstimateHardness(Values + i * BOARD_CELLS);
+        b->Classes[i] = Estimates[i].Class;
+        if (s->Config.HardFirst && b->Classes[i] == HARDNESS_HARD) b->Hard[b->HardCount++] = i;
+        else b->Rest[b->RestCount++] = i;
+    }
+    if (s->Config.HardFirst) {
+        SortByHardness(b->Hard, b->HardCount, Estimates, Scratch);
+        SortByHardness(b->Rest, b->RestCount, Estimates, Scratch);
+        if (s->GroupSize > 1) {
+            GroupByClass(b->Rest, b->RestCount, b->Classes, Scratch);
+        }
+    }
+    free(Estimates);
+    free(Scratch);
+    b->Remaining = count;
+
+    pthread_mutex_lock(&s->Lock);
+    s->Pending[s->PendingCount++] = b;
+    pthread_cond_broadcast(&s->Work);
+    pthread_mutex_unlock(&s->Lock);
+    return true;
+}
+
+// NOTE: Function that blocks until every board of b is solved, then adds its latencies and Batch Backend
+// breakdown to stats and batch
+void SchedulerWait(Scheduler *s, ScheduleBatch *b, ScheduleStats *stats, BatchStats *batch) {
+    if (b->Count <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&s->Lock);
+    while (b->Remaining > 0) {
+        pthread_cond_wait(&s->Finished, &s->Lock);
+    }
+    int Slot = 0;
+    while (Slot < s->PendingCount && s->Pending[Slot] != b) ++Slot;
+    for (; Slot + 1 < s->PendingCount; ++Slot) s->Pending[Slot] = s->Pending[Slot + 1];
+    s->PendingCount--;
+    pthread_mutex_unlock(&s->Lock);
+
+    double Last = b->Start;
+    for (int i = 0; i < b->Count; ++i) {
+        RecordLatency(&stats->Latency[b->Classes[i]], (b->Done[i] - b->Start) * 1e6);
+        if (b->Done[i] > Last) Last = b->Done[i];
+    }
+    // Only the part of this batch that did not overlap the batches before it adds to the makespan
+    double From = b->Start > s->LastDone ? b->Start : s->LastDone;
+    if (Last > From) {
+        stats->Makespan += Last - From;
+        s->LastDone = Last;
+    }
+    stats->Groups += (uint64_t)b->Groups;
+    stats->MixedGroups += (uint64_t)b->MixedGroups;
+    if (s->PeakHard > stats->PeakHard) stats->PeakHard = s->PeakHard;
+    if (batch != NULL) {
+        batch->Propagated += b->Batch.Propagated;
+        batch->Branched += b->Batch.Branched;
+        batch->Contradicted += b->Batch.Contradicted;
+    }
+
+    free(b->Classes);
+    free(b->Hard);
+    free(b->Done);
+    b->Classes = NULL;
+    b->Hard = b->Rest = NULL;
+    b->Done = NULL;
+}
+
+// NOTE: Function that stops the pool once the groups being solved are done
+// Batches that were not waited for (after an error) are dropped with the boards they had not started yet.
+void SchedulerStop(Scheduler *s) {
+    pthread_mutex_lock(&s->Lock);
+    s->Stopping = true;
+    pthread_cond_broadcast(&s->Work);
+    pthread_mutex_unlock(&s->Lock);
+    for (int i = 0; i < s->Started; ++i) {
+        pthread_join(s->Threads[i], NULL);
+    }
+    for (int i = 0; i < s->PendingCount; ++i) {
+        ScheduleBatch *b = s->Pending[i];
+        free(b->Classes);
+        free(b->Hard);
+        free(b->Done);
+        b->Classes = NULL;
+        b->Hard = b->Rest = NULL;
+        b->Done = NULL;
+    }
+    s->PendingCount = 0;
+    pthread_mutex_destroy(&s->Lock);
+    pthread_cond_destroy(&s->Work);
+    pthread_cond_destroy(&s->Finished);
+}
+
+// NOTE: Function that prints the latency of every hardness class, the total makespan and how boards were grouped
+void PrintScheduleStats(const ScheduleStats *stats) {
+    fprintf(stderr, "[INFO]: Makespan %.3f s\n", stats->Makespan);
+    fprintf(stderr, "[INFO]: %llu Groups (%llu Mixing Classes), at most %d Hard Groups at once ahead of easier Puzzles\n",
+            (unsigned long long)stats->Groups, (unsigned long long)stats->MixedGroups, stats->PeakHard);
+    for (int c = 0; c < HARDNESS_CLASSES; ++c) {
+        const LatencyHistogram *h = &stats->Latency[c];
+        if (h->Puzzles == 0) continue;
+        fprintf(stderr, "[INFO]: %-6s %8llu Puzzles, Latency mean %.0f us, p50 %.0f us, p99 %.0f us, max %.0f us\n",
+                HardnessName((HardnessClass)c), (unsigned long long)h->Puzzles, h->TotalMicros / (double)h->Puzzles,
+                LatencyPercentile(h, 0.50), LatencyPercentile(h, 0.99), h->MaxMicros);
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "sudoku.h"
+#include "batch.h"
+
+// NOTE: Hardness-Aware Scheduling
+// Before a batch is solved every puzzle gets a cheap hardness estimate: its clue count, how many cells are still
+// open after naked and hidden singles (the residue) and the candidate entropy of those cells. Very low clue counts
+// add to the score too, since plain Search does not propagate and suffers from them even when singles would do.
+// Worker threads take the likely-hard puzzles first, so they do not start last and stretch the batch, while at
+// most MaxHard of them run at once so the easy ones keep flowing. The solver itself is not changed.
+#define HARD_SCORE 45.0             // Score from which a puzzle counts as hard
+#define LOW_CLUES 25                // Every clue below this adds CLUE_WEIGHT to the score
+#define CLUE_WEIGHT 8.0
+#define LATENCY_BUCKETS 128         // Log-scale buckets, 4 per power of two microseconds
+#define SCHEDULE_MAX_WORKERS 64
+#define SCHEDULE_MAX_GROUP BATCH_LANES
+
+typedef enum {
+    HARDNESS_EASY,      // Solved (or refuted) by singles alone and not short of clues
+    HARDNESS_MEDIUM,
+    HARDNESS_HARD,
+    HARDNESS_CLASSES,
+} HardnessClass;
+
+typedef struct {
+    int Clues;
+    int Residue;            // Empty cells left after the singles pass
+    double Entropy;         // Sum of log2(candidates) over those cells
+    double Score;           // Entropy plus the low clue count penalty; higher starts earlier
+    HardnessClass Class;
+} Hardness;
+
+typedef struct {
+    int Workers;            // Solver threads; 0 solves the batch in order on the calling thread
+    bool HardFirst;         // Order by estimated hardness instead of input order
+    int MaxHard;            // Hard puzzles (or groups of them) running at once while easier ones wait (0 for no cap)
+} ScheduleConfig;
+
+typedef struct {
+    uint64_t Count[LATENCY_BUCKETS];
+    uint64_t Puzzles;
+    double TotalMicros;
+    double MaxMicros;
+} LatencyHistogram;
+
+typedef struct {
+    LatencyHistogram Latency[HARDNESS_CLASSES];     // Batch submitted to puzzle done, per class
+    double Makespan;                                // Time during which any batch was in flight (s)
+    uint64_t Groups;                                // Groups of boards handed to the solve function
+    uint64_t MixedGroups;                           // Groups whose boards were not all of one class
+    int PeakHard;                                   // Most hard groups running when one started ahead of easier boards
+} ScheduleStats;
+
+// Solves count consecutive boards in place; stats (never NULL) is added to by backends that report any
+typedef void (*SolveFunction)(void *context, int *Values, int count, bool *Solved, BatchStats *stats);
+
+// One batch of boards handed to the Scheduler, solved in place; see SchedulerSubmit
+typedef struct {
+    int *Values;
+    bool *Solved;
+    int Count;
+    double Start;               // When the batch was submitted
+    double *Done;               // Completion time of each board
+    HardnessClass *Classes;
+    int *Hard;                  // Indices of hard boards in the order they should start
+    int HardCount;
+    int NextHard;
+    int *Rest;                  // All other indices in the order they should start
+    int RestCount;
+    int NextRest;
+    int Remaining;              // Boards not solved yet
+    int Groups;                 // Groups started so far
+    int MixedGroups;            // Of which mixed hardness classes
+    BatchStats Batch;           // What the solve function reported for this batch
+} ScheduleBatch;
+
+// NOTE: Persistent pool of solver threads
+// Up to SCHEDULE_WINDOW batches are in flight at once and a thread moves on to the next batch as soon as the
+// older one has nothing left to start, so the threads stay busy while the last boards of a batch finish and the
+// caller writes it out. Boards are taken GroupSize at a time; with hardness ordering a group never mixes classes.
+#define SCHEDULE_WINDOW 2
+
+typedef struct {
+    ScheduleConfig Config;
+    SolveFunction Solve;
+    void *Context;
+    int GroupSize;              // Boards handed to Solve at once (at most SCHEDULE_MAX_GROUP)
+    pthread_mutex_t Lock;
+    pthread_cond_t Work;        // A batch was submitted or the pool is stopping
+    pthread_cond_t Finished;    // A batch was completed
+    ScheduleBatch *Pending[SCHEDULE_WINDOW];    // Submitted batches, oldest first
+    int PendingCount;
+    int RunningHard;            // Groups of hard boards being solved
+    int PeakHard;               // Most RunningHard reached by a group started while easier boards were waiting
+    bool Stopping;
+    double LastDone;            // Latest completion seen by SchedulerWait, so overlapping batches count once
+    pthread_t Threads[SCHEDULE_MAX_WORKERS];
+    int Started;
+} Scheduler;
+
+const char *HardnessName(HardnessClass c);
+Hardness EstimateHardness(const int Values[BOARD_CELLS]);
+bool SchedulerStart(Scheduler *s, const ScheduleConfig *config, int group_size, SolveFunction solve, void *context);
+bool SchedulerSubmit(Scheduler *s, ScheduleBatch *b, int *Values, int count, bool *Solved);
+void SchedulerWait(Scheduler *s, ScheduleBatch *b, ScheduleStats *stats, BatchStats *batch);
+void SchedulerStop(Scheduler *s);
+double LatencyPercentile(const LatencyHistogram *h, double p);
+void PrintScheduleStats(const ScheduleStats *stats);
+
+#endif // SCHEDULE_H
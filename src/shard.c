@@ -0,0 +1,329 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "shard.h"
+#include "archive.h"
+
+typedef enum {
+    SHARD_PENDING,
+    SHARD_RUNNING,
+    SHARD_DONE,
+} ShardStatus;
+
+typedef struct {
+    uint64_t Start;
+    uint64_t End;
+    ShardStatus Status;
+    int Attempts;
+    pid_t Pid;
+    int Slot;               // Worker slot running the shard
+    char Path[PATH_MAX];    // Output of the shard
+} Shard;
+
+// NOTE: Local Launcher: fork and exec the worker on this machine
+static pid_t LaunchLocal(const Launcher *l, char *const argv[]) {
+    (void)l;
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        execv(argv[0], argv);
+        fprintf(stderr, "ERROR: Failed To Start Worker %s: %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    return pid;
+}
+
+// NOTE: Command Launcher: run "PREFIX 'ARG' 'ARG' ..." through /bin/sh, e.g. with PREFIX "ssh host"
+// The input and output paths must be visible to the worker under the same names (a shared file system).
+static pid_t LaunchCommand(const Launcher *l, char *const argv[]) {
+    size_t Size = strlen(l->Prefix) + 6;
+    for (int i = 0; argv[i] != NULL; ++i) Size += 4 * strlen(argv[i]) + 3;
+    char *Command = (char *)malloc(Size);
+    if (Command == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        return -1;
+    }
+
+    char *p = Command + sprintf(Command, "exec %s", l->Prefix);
+    for (int i = 0; argv[i] != NULL; ++i) {
+        *p++ = ' ';
+        *p++ = '\'';
+        for (const char *s = argv[i]; *s; ++s) {
+            if (*s == '\'') {
+                memcpy(p, "'\\''", 4);
+                p += 4;
+            } else {
+                *p++ = *s;
+            }
+        }
+        *p++ = '\'';
+    }
+    *p = '\0';
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        execl("/bin/sh", "sh", "-c", Command, (char *)NULL);
+        _exit(127);
+    }
+    free(Command);
+    return pid;
+}
+
+Launcher LocalLauncher(void) {
+    Launcher l = { "local", LaunchLocal, NULL };
+    return l;
+}
+
+Launcher CommandLauncher(const char *prefix) {
+    Launcher l = { prefix, LaunchCommand, prefix };
+    return l;
+}
+
+// NOTE: Function that cuts [0, size) into at most count ranges that start and end on puzzle record boundaries
+// The records are read with the same parser as the workers, so a grid layout spanning several lines is never cut
+// in half; a cut lands after the first record that ends at or beyond size / count * i.
+static int SplitInput(const char *path, uint64_t size, int count, int box, Shard *shards) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, READ_FILE_FAILED, path);
+        return -1;
+    }
+    int *Values = (int *)malloc(sizeof(int) * (size_t)(box * box * box * box));
+    if (Values == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        fclose(f);
+        return -1;
+    }
+    int Count = 0;
+    uint64_t Start = 0;
+    for (int i = 1; i <= count && Start < size; ++i) {
+        uint64_t End = size;
+        if (i < count) {
+            uint64_t Target = size / (uint64_t)count * (uint64_t)i;
+            End = Start;
+            while (End < Target && ScanPuzzleRecord(f, Values, box) != RECORD_END) {
+                End = (uint64_t)ftello(f);
+            }
+            if (End < Target) End = size;
+        }
+        if (End == Start) continue;
+
+        Shard *s = &shards[Count++];
+        memset(s, 0, sizeof(*s));
+        s->Start = Start;
+        s->End = End;
+        s->Status = SHARD_PENDING;
+        s->Pid = -1;
+        Start = End;
+    }
+    fclose(f);
+    free(Values);
+    return Count;
+}
+
+// NOTE: Function that appends the file at path to out_fd
+static bool AppendFile(int out_fd, const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, READ_FILE_FAILED, path);
+        return false;
+    }
+    bool Ok = true;
+    for (;;) {
+        ssize_t n = read(fd, buf, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            Ok = n == 0;
+            break;
+        }
+        for (ssize_t Written = 0; Ok && Written < n;) {
+            ssize_t w = write(out_fd, buf + Written, (size_t)(n - Written));
+            if (w < 0 && errno == EINTR) continue;
+            Ok = w > 0;
+            Written += w > 0 ? w : 0;
+        }
+        if (!Ok) break;
+    }
+    close(fd);
+    if (!Ok) {
+        fprintf(stderr, "ERROR: Failed To Merge %s: %s\n", path, strerror(errno));
+    }
+    return Ok;
+}
+
+// NOTE: Function that starts a worker for shard s in the given slot, returns false if it could not be started
+static bool StartShard(const CoordinatorConfig *config, const char *self, Shard *s, int slot) {
+    char Start[32], End[32];
+    snprintf(Start, sizeof(Start), "%llu", (unsigned long long)s->Start);
+    snprintf(End, sizeof(End), "%llu", (unsigned long long)s->End);
+
+    char **argv = (char **)malloc(sizeof(char *) * (size_t)(config->WorkerArgCount + 7));
+    if (argv == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        return false;
+    }
+    int n = 0;
+    argv[n++] = (char *)self;
+    argv[n++] = (char *)"--shard";
+    argv[n++] = (char *)config->InPath;
+    argv[n++] = Start;
+    argv[n++] = End;
+    argv[n++] = s->Path;
+    for (int i = 0; i < config->WorkerArgCount; ++i) argv[n++] = config->WorkerArgs[i];
+    argv[n] = NULL;
+
+    const Launcher *l = &config->Launchers[slot % config->LauncherCount];
+    s->Pid = l->Launch(l, argv);
+    free(argv);
+    if (s->Pid < 0) {
+        fprintf(stderr, "ERROR: Launcher %s Failed: %s\n", l->Name, strerror(errno));
+        return false;
+    }
+    s->Status = SHARD_RUNNING;
+    s->Slot = slot;
+    return true;
+}
+
+// NOTE: Function that records a failed attempt, returns false once the shard has used up its retries
+static bool RetryShard(const CoordinatorConfig *config, Shard *s, int index) {
+    s->Status = SHARD_PENDING;
+    s->Pid = -1;
+    s->Attempts++;
+    remove(s->Path);
+    if (s->Attempts > config->Retries) {
+        fprintf(stderr, "ERROR: Shard %d Failed %d Times, Giving Up\n", index, s->Attempts);
+        return false;
+    }
+    fprintf(stderr, "[INFO]: Shard %d Failed (Attempt %d), Retrying\n", index, s->Attempts);
+    return true;
+}
+
+// NOTE: Function that runs a whole sharded job: split, run the workers with retries, then merge in order
+bool RunCoordinator(const CoordinatorConfig *config) {
+    if (config->Workers < 1 || config->LauncherCount < 1) {
+        fprintf(stderr, "ERROR: A Coordinator needs at least one Worker and one Launcher\n");
+        return false;
+    }
+    char Self[PATH_MAX];
+    ssize_t SelfLength = readlink("/proc/self/exe", Self, sizeof(Self) - 1);
+    if (SelfLength < 0) {
+        fprintf(stderr, "ERROR: Failed To Locate the Worker Executable: %s\n", strerror(errno));
+        return false;
+    }
+    Self[SelfLength] = '\0';
+
+    struct stat Info;
+    if (stat(config->InPath, &Info) != 0) {
+        fprintf(stderr, READ_FILE_FAILED, config->InPath);
+        return false;
+    }
+    int Requested = config->Shards > 0 ? config->Shards : config->Workers * SHARDS_PER_WORKER;
+    Shard *Shards = (Shard *)calloc((size_t)Requested, sizeof(Shard));
+    bool *Busy = (bool *)calloc((size_t)config->Workers, sizeof(bool));
+    if (Shards == NULL || Busy == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        free(Shards);
+        free(Busy);
+        return false;
+    }
+    int Count = SplitInput(config->InPath, (uint64_t)Info.st_size, Requested, config->Box, Shards);
+    bool Ok = Count >= 0;
+    for (int i = 0; i < Count; ++i) {
+        snprintf(Shards[i].Path, sizeof(Shards[i].Path), "%s.shard%d", config->OutPath, i);
+    }
+    if (Ok) {
+        fprintf(stderr, "[INFO]: Split %s into %d Shards for %d Workers\n", config->InPath, Count, config->Workers);
+    }
+
+    int Done = 0, Running = 0, Next = 0;
+    bool Malformed = false;
+    while (Ok && Done < Count) {
+        // Fill every free slot with the next pending shard
+        for (int slot = 0; Ok && slot < config->Workers; ++slot) {
+            if (Busy[slot]) continue;
+            while (Next < Count && Shards[Next].Status != SHARD_PENDING) Next++;
+            if (Next == Count) {
+                Next = 0;
+                while (Next < Count && Shards[Next].Status != SHARD_PENDING) Next++;
+                if (Next == Count) break;
+            }
+            if (StartShard(config, Self, &Shards[Next], slot)) {
+                Busy[slot] = true;
+                Running++;
+            } else {
+                Ok = RetryShard(config, &Shards[Next], Next);
+            }
+        }
+        if (Running == 0) {
+            continue;
+        }
+
+        int Status;
+        pid_t pid = waitpid(-1, &Status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: waitpid Failed: %s\n", strerror(errno));
+            Ok = false;
+            break;
+        }
+        int i = 0;
+        while (i < Count && !(Shards[i].Status == SHARD_RUNNING && Shards[i].Pid == pid)) ++i;
+        if (i == Count) continue;
+
+        Shard *s = &Shards[i];
+        Busy[s->Slot] = false;
+        Running--;
+        int Exit = WIFEXITED(Status) ? WEXITSTATUS(Status) : -1;
+        if ((Exit == 0 || Exit == SHARD_EXIT_MALFORMED) && access(s->Path, F_OK) == 0) {
+            // Malformed records fail the same way on every attempt, so the shard is kept instead of retried
+            s->Status = SHARD_DONE;
+            Done++;
+            Malformed = Malformed || Exit == SHARD_EXIT_MALFORMED;
+            fprintf(stderr, "[INFO]: Shard %d Done (%d of %d)\n", i, Done, Count);
+        } else {
+            Ok = RetryShard(config, s, i);
+        }
+    }
+
+    // Stop whatever is still running after a failure (each worker leads its own process group)
+    for (int i = 0; i < Count && Running > 0; ++i) {
+        if (Shards[i].Status == SHARD_RUNNING) {
+            kill(-Shards[i].Pid, SIGTERM);
+            waitpid(Shards[i].Pid, NULL, 0);
+            Running--;
+        }
+    }
+
+    if (Ok) {
+        int fd = open(config->OutPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        char *Buf = (char *)malloc(WRITER_CAPACITY);
+        Ok = fd >= 0 && Buf != NULL;
+        if (!Ok) {
+            fprintf(stderr, "ERROR: Failed To Open %s For Writing: %s\n", config->OutPath, strerror(errno));
+        }
+        for (int i = 0; Ok && i < Count; ++i) {
+            Ok = AppendFile(fd, Shards[i].Path, Buf, WRITER_CAPACITY);
+        }
+        if (fd >= 0 && close(fd) != 0) Ok = false;
+        free(Buf);
+    }
+    for (int i = 0; i < Count; ++i) {
+        remove(Shards[i].Path);
+        char Tmp[PATH_MAX + 8];
+        snprintf(Tmp, sizeof(Tmp), "%s.tmp", Shards[i].Path);
+        remove(Tmp);
+    }
+    if (Ok) {
+        fprintf(stderr, "[INFO]: Merged %d Shards into %s\n", Count, config->OutPath);
+    }
+    if (Ok && Malformed) {
+        fprintf(stderr, "ERROR: %s has Malformed Records, written out as \"ERROR\"\n", config->InPath);
+        Ok = false;
+    }
+    free(Shards);
+    free(Busy);
+    return Ok;
+}
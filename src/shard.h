@@ -0,0 +1,47 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "stream.h"
+
+// NOTE: Sharded Batch Runs
+// The coordinator cuts the input into byte-range shards that start and end on puzzle record boundaries
+// and hands each to a worker process (`main --shard IN START END SHARD_OUT ...`). A shard whose worker exits
+// unsuccessfully or leaves no output is queued again, up to Retries more times. Once every shard is done the shard
+// outputs are concatenated in input order, so OUT matches what `--batch IN OUT` would have written.
+// A worker that wrote its shard but met malformed records exits with SHARD_EXIT_MALFORMED; such a shard is
+// merged rather than retried, and the whole run then fails.
+#define SHARD_MAX_LAUNCHERS 16
+#define SHARDS_PER_WORKER 4     // Default shard count per worker, so a retried shard is a small part of the job
+#define SHARD_EXIT_MALFORMED 2  // Worker exit status: shard written, but some records were not puzzles
+
+// Starts a worker process running argv and returns its pid (-1 on failure)
+struct Launcher;
+typedef pid_t (*LaunchFunction)(const struct Launcher *l, char *const argv[]);
+
+typedef struct Launcher {
+    const char *Name;
+    LaunchFunction Launch;
+    const char *Prefix;     // Command the worker is run through (e.g. "ssh host"), NULL for local launchers
+} Launcher;
+
+typedef struct {
+    const char *InPath;
+    const char *OutPath;
+    int Workers;                // Worker processes running at once
+    int Shards;                 // 0 for Workers * SHARDS_PER_WORKER
+    int Retries;                // Extra attempts per shard
+    int Box;                    // Box size of the input boards, for finding record boundaries
+    const Launcher *Launchers;  // Worker slot i uses Launchers[i % LauncherCount]
+    int LauncherCount;
+    char **WorkerArgs;          // Stream options passed on to every worker
+    int WorkerArgCount;
+} CoordinatorConfig;
+
+Launcher LocalLauncher(void);
+Launcher CommandLauncher(const char *prefix);
+bool RunCoordinator(const CoordinatorConfig *config);
+
+#endif // SHARD_H
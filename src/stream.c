@@ -0,0 +1,561 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "stream.h"
+#include "archive.h"
+#include "sat.h"
+#include "batch.h"
+#include "portfolio.h"
+#include "checkpoint.h"
+#include "masks.h"
+
+// NOTE: Function that initializes a Writer with a buffer of the given capacity
+bool WriterInit(Writer *w, int fd, size_t capacity) {
+    w->fd = fd;
+    w->count = 0;
+    w->capacity = capacity;
+    w->buf = (char *)malloc(capacity);
+    if (w->buf == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        return false;
+    }
+    return true;
+}
+
+// NOTE: Function that writes everything buffered so far, retrying short writes
+bool WriterFlush(Writer *w) {
+    size_t Written = 0;
+    while (Written < w->count) {
+        ssize_t n = write(w->fd, w->buf + Written, w->count - Written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: Failed To Write Output: %s\n", strerror(errno));
+            return false;
+        }
+        Written += (size_t)n;
+    }
+    w->count = 0;
+    return true;
+}
+
+// NOTE: Function that appends bytes to the Writer, flushing when the buffer fills up
+bool WriterPut(Writer *w, const char *data, size_t n) {
+    while (n > 0) {
+        if (w->count == w->capacity && !WriterFlush(w)) {
+            return false;
+        }
+        size_t Chunk = w->capacity - w->count < n ? w->capacity - w->count : n;
+        memcpy(w->buf + w->count, data, Chunk);
+        w->count += Chunk;
+        data += Chunk;
+        n -= Chunk;
+    }
+    return true;
+}
+
+// NOTE: Function that frees the Writer buffer (call WriterFlush first)
+void WriterFree(Writer *w) {
+    free(w->buf);
+    w->buf = NULL;
+    w->count = 0;
+    w->capacity = 0;
+}
+
+// NOTE: Function that writes a puzzle as a single line of 81 digits
+bool WritePuzzleLine(Writer *w, const int Values[BOARD_CELLS]) {
+    return WritePuzzleLineN(w, Values, 3);
+}
+
+// NOTE: Same as WritePuzzleLine for boards made of box x box boxes (values above 9 are written A, B, ...)
+bool WritePuzzleLineN(Writer *w, const int *Values, int box) {
+    char Line[SAT_MAX_BOX * SAT_MAX_BOX * SAT_MAX_BOX * SAT_MAX_BOX + 1];
+    int Cells = box * box * box * box;
+    for (int i = 0; i < Cells; ++i) {
+        Line[i] = (char)(Values[i] < 10 ? '0' + Values[i] : 'A' + Values[i] - 10);
+    }
+    Line[Cells] = '\n';
+    return WriterPut(w, Line, (size_t)Cells + 1);
+}
+
+// NOTE: Function that returns the name of a backend as accepted by --backend
+const char *BackendName(SolverBackend backend) {
+    switch (backend) {
+    case BACKEND_SEARCH: return "search";
+    case BACKEND_SAT: return "sat";
+    case BACKEND_BATCH: return "batch";
+    case BACKEND_PORTFOLIO: return "portfolio";
+    }
+    return "unknown";
+}
+
+// NOTE: Function that solves Values in place with the requested backend
+// 9x9 givens that already repeat a digit fail before any backend runs; larger boards leave that to the SAT Backend,
+// whose unit propagation refutes them immediately.
+bool SolveWithBackend(const StreamConfig *config, SolverBackend backend, int *Values) {
+    int box = config->Box;
+    MaskBoard Givens;
+    if (box == 3 && !MaskBoardInit(&Givens, Values)) {
+        return false;
+    }
+    switch (backend) {
+    case BACKEND_SEARCH:
+        if (box != 3) {
+            fprintf(stderr, "ERROR: Search only supports 9x9 Boards\n");
+            return false;
+        }
+        return SolveValues(Values);
+    case BACKEND_SAT:
+        return SatSolveValues(Values, box, NULL);
+    case BACKEND_BATCH: {
+        if (box != 3) {
+            fprintf(stderr, "ERROR: The Batch Kernel only supports 9x9 Boards\n");
+            return false;
+        }
+        bool Solved = false;
+        BatchSolveValues(Values, 1, &Solved, NULL);
+        return Solved;
+    }
+    case BACKEND_PORTFOLIO: {
+        if (box != 3) {
+            fprintf(stderr, "ERROR: The Portfolio only supports 9x9 Boards\n");
+            return false;
+        }
+        PortfolioMember Members[PORTFOLIO_MAX];
+        PortfolioResult Result;
+        int Count = DefaultPortfolio(Members, config->Threads);
+        return PortfolioSolveValues(Values, Members, Count, &Result);
+    }
+    }
+    return false;
+}
+
+// NOTE: Only the SAT Backend handles boards other than 9x9
+static bool BackendSupportsBox(SolverBackend backend, int box) {
+    return box == 3 || backend == BACKEND_SAT;
+}
+
+// NOTE: Function that records the result of one puzzle, cross-checking against another backend if asked to
+static void FinishStreamPuzzle(const StreamConfig *config, const int *Puzzle, const int *Values, bool Solved,
+                               int *Scratch, int Cells, StreamStats *stats) {
+    if (Solved) {
+        ++stats->Solved;
+    } else {
+        ++stats->Failed;
+    }
+    ++stats->Puzzles;
+
+    if (config->Check) {
+        // Cross-check with an independent solver: SAT for the search based backends and the MRV bitmask search for
+        // SAT, which is not slowed down by the boards that stall row-major Search. Other box sizes only have SAT,
+        // so there CheckSolution has to do.
+        bool Agree = true;
+        if (config->Backend != BACKEND_SAT || config->Box == 3) {
+            memcpy(Scratch, Puzzle, sizeof(int) * Cells);
+            bool OtherSolved = config->Backend == BACKEND_SAT ? MaskSolveValues(Scratch)
+                                                              : SolveWithBackend(config, BACKEND_SAT, Scratch);
+            Agree = Solved == OtherSolved && (!Solved || CheckSolution(Puzzle, Scratch, config->Box));
+        }
+        if (Agree && Solved) {
+            Agree = CheckSolution(Puzzle, Values, config->Box);
+        }
+        if (!Agree) {
+            fprintf(stderr, "ERROR: Backends disagree on Puzzle %llu\n", (unsigned long long)(stats->Puzzles - 1));
+            ++stats->Mismatched;
+        }
+    }
+}
+
+// NOTE: Function that solves count consecutive boards of Values in place with config->Backend
+// The Batch Backend gets all of them at once so it can fill its lanes; the others go one at a time.
+void SolveManyWithBackend(const StreamConfig *config, int *Values, int count, bool *Solved, BatchStats *stats) {
+    int Cells = config->Box * config->Box * config->Box * config->Box;
+    if (config->Backend == BACKEND_BATCH && config->Box == 3) {
+        BatchSolveValues(Values, count, Solved, stats);
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        Solved[i] = SolveWithBackend(config, config->Backend, Values + i * Cells);
+    }
+}
+
+// NOTE: SolveFunction that lets the scheduler's threads run the configured backend
+static void SolveScheduled(void *context, int *Values, int count, bool *Solved, BatchStats *stats) {
+    SolveManyWithBackend((const StreamConfig *)context, Values, count, Solved, stats);
+}
+
+// NOTE: Function that rejects backend / box size / scheduling combinations that cannot work or would be ignored
+bool ValidStreamConfig(const StreamConfig *config) {
+    if (config->Box < 2 || config->Box > SAT_MAX_BOX) {
+        fprintf(stderr, "ERROR: Unsupported Box Size %d\n", config->Box);
+        return false;
+    }
+    if (!BackendSupportsBox(config->Backend, config->Box)) {
+        fprintf(stderr, "ERROR: Only the SAT Backend supports Box Size %d\n", config->Box);
+        return false;
+    }
+    if (config->Schedule.Workers > 0 && config->Box != 3) {
+        fprintf(stderr, "ERROR: --jobs only schedules 9x9 Boards, not Box Size %d\n", config->Box);
+        return false;
+    }
+    if (config->Schedule.Workers == 0 && (config->Schedule.HardFirst || config->Schedule.MaxHard > 0)) {
+        fprintf(stderr, "ERROR: --schedule hardness and --max-hard need --jobs N\n");
+        return false;
+    }
+    if (config->Schedule.MaxHard > 0 && !config->Schedule.HardFirst) {
+        fprintf(stderr, "ERROR: --max-hard needs --schedule hardness\n");
+        return false;
+    }
+    return true;
+}
+
+// NOTE: Checkpointing state of a RunBatch call
+typedef struct {
+    const char *Path;
+    uint64_t Every;         // Batches between two checkpoints
+    CheckpointState State;
+} CheckpointRun;
+
+// NOTE: Function that commits everything written so far and records it in a checkpoint
+// input_offset is where the input continues after the last record written, which is behind ftello(in)
+// while the next batch is already being solved.
+static bool CommitCheckpoint(CheckpointRun *cp, uint64_t input_offset, Writer *w, const StreamStats *stats) {
+    if (!WriterFlush(w) || fsync(w->fd) != 0) {
+        fprintf(stderr, "ERROR: Failed To Sync Output: %s\n", strerror(errno));
+        return false;
+    }
+    off_t OutputOffset = lseek(w->fd, 0, SEEK_CUR);
+    if (OutputOffset < 0) {
+        fprintf(stderr, "ERROR: Failed To Read File Offsets: %s\n", strerror(errno));
+        return false;
+    }
+    cp->State.InputOffset = input_offset;
+    cp->State.OutputOffset = (uint64_t)OutputOffset;
+    cp->State.Stats = *stats;
+    return SaveCheckpoint(cp->Path, &cp->State);
+}
+
+// One batch of input records on its way through the stream
+typedef struct {
+    int *Values;                    // Puzzles being solved
+    int *Original;                  // Copy of them as read
+    bool Solved[STREAM_BATCH];
+    bool Malformed[STREAM_BATCH];   // Per record of the batch, in input order
+    int Records;
+    int Count;                      // Puzzles among the Records
+    off_t InputOffset;              // Input offset just after the last record
+    bool Submitted;                 // Handed to the Scheduler rather than solved right away
+    ScheduleBatch Job;
+} StreamSlot;
+
+// NOTE: Function that reads up to STREAM_BATCH records into a slot, returns false at the end of the input
+static bool ReadStreamSlot(FILE *in, const StreamConfig *config, StreamSlot *slot, int Cells) {
+    slot->Records = 0;
+    slot->Count = 0;
+    while (slot->Records < STREAM_BATCH) {
+        RecordStatus Record = ReadPuzzleRecord(in, slot->Values + slot->Count * Cells, config->Box);
+        if (Record == RECORD_END) break;
+        slot->Malformed[slot->Records++] = Record == RECORD_MALFORMED;
+        if (Record == RECORD_PUZZLE) {
+            ++slot->Count;
+        }
+    }
+    slot->InputOffset = ftello(in);
+    memcpy(slot->Original, slot->Values, sizeof(int) * Cells * slot->Count);
+    return slot->Records == STREAM_BATCH;
+}
+
+// NOTE: Function that records and writes out a solved slot, in input order
+static bool WriteStreamSlot(Writer *w, const StreamConfig *config, StreamSlot *slot, int *Scratch, int Cells,
+                            StreamStats *stats) {
+    for (int i = 0; i < slot->Count; ++i) {
+        FinishStreamPuzzle(config, slot->Original + i * Cells, slot->Values + i * Cells, slot->Solved[i], Scratch, Cells, stats);
+    }
+    bool Ok = true;
+    for (int r = 0, i = 0; Ok && r < slot->Records; ++r) {
+        if (slot->Malformed[r]) {
+            ++stats->Malformed;
+            Ok = WriterPut(w, MALFORMED_LINE, sizeof(MALFORMED_LINE) - 1);
+        } else {
+            Ok = WritePuzzleLineN(w, slot->Values + i++ * Cells, config->Box);
+        }
+    }
+    return Ok;
+}
+
+// NOTE: Function that solves puzzles from in and writes one solution line per puzzle through w
+// Puzzles are read, solved and written STREAM_BATCH at a time; unsolvable puzzles are written unchanged and
+// malformed records as MALFORMED_LINE, so that output line N always belongs to input record N.
+// With Schedule.Workers the batches go to a Scheduler, which already solves the next batch while the previous
+// one is finished and written. stats is added to, not reset.
+static bool ProcessStream(FILE *in, Writer *w, const StreamConfig *config, StreamStats *stats, CheckpointRun *cp) {
+    int Cells = config->Box * config->Box * config->Box * config->Box;
+    Scheduler Pool;
+    bool Scheduled = config->Schedule.Workers > 0 && config->Box == 3
+                     && SchedulerStart(&Pool, &config->Schedule, config->Backend == BACKEND_BATCH ? BATCH_LANES : 1,
+                                       SolveScheduled, (void *)config);
+    int Window = Scheduled ? SCHEDULE_WINDOW : 1;
+
+    // Every slot holds the puzzles being solved and a copy of them as read; Scratch is one puzzle for --check
+    StreamSlot Slots[SCHEDULE_WINDOW];
+    int *Buffer = (int *)malloc(sizeof(int) * Cells * (2 * STREAM_BATCH * Window + 1));
+    if (Buffer == NULL) {
+        fprintf(stderr, ALLOCATION_FAILED);
+        if (Scheduled) SchedulerStop(&Pool);
+        return false;
+    }
+    for (int i = 0; i < Window; ++i) {
+        Slots[i].Values = Buffer + Cells * STREAM_BATCH * (2 * i);
+        Slots[i].Original = Buffer + Cells * STREAM_BATCH * (2 * i + 1);
+    }
+    int *Scratch = Buffer + Cells * STREAM_BATCH * 2 * Window;
+
+    bool Ok = true;
+    bool Done = false;
+    uint64_t Read = 0, Written = 0;
+    while (Ok) {
+        if (!Done) {
+            StreamSlot *Slot = &Slots[Read++ % Window];
+            PerfReading Reading;
+            PerfStart(config->Counters, &Reading);
+            Done = !ReadStreamSlot(in, config, Slot, Cells);
+            PerfStop(config->Counters, &Reading, &stats->Load);
+
+            PerfStart(config->Counters, &Reading);
+            Slot->Submitted = Scheduled && SchedulerSubmit(&Pool, &Slot->Job, Slot->Values, Slot->Count, Slot->Solved);
+            if (!Slot->Submitted) {
+                SolveManyWithBackend(config, Slot->Values, Slot->Count, Slot->Solved, &stats->Batch);
+            }
+            PerfStop(config->Counters, &Reading, &stats->Solve);
+        }
+        if (Written == Read) {
+            break;
+        }
+        if (!Done && Read - Written < (uint64_t)Window) {
+            continue;
+        }
+
+        // Finish the oldest batch while the Scheduler works on the ones behind it
+        StreamSlot *Slot = &Slots[Written++ % Window];
+        if (Slot->Submitted) {
+            PerfReading Reading;
+            PerfStart(config->Counters, &Reading);
+            SchedulerWait(&Pool, &Slot->Job, &stats->Schedule, &stats->Batch);
+            PerfStop(config->Counters, &Reading, &stats->Solve);
+        }
+        Ok = WriteStreamSlot(w, config, Slot, Scratch, Cells, stats);
+
+        if (Ok && cp != NULL && !(Done && Written == Read) && Written % cp->Every == 0) {
+            Ok = Slot->InputOffset >= 0 && CommitCheckpoint(cp, (uint64_t)Slot->InputOffset, w, stats);
+        }
+    }
+
+    // After a failure batches may still be running; stopping the pool waits for them before the buffers go
+    if (Scheduled) {
+        SchedulerStop(&Pool);
+    }
+    Ok = Ok && WriterFlush(w) && !ferror(in);
+    free(Buffer);
+    return Ok;
+}
+
+// NOTE: Function that solves puzzles from in and writes one solution line per puzzle to out_fd
+bool RunStream(FILE *in, int out_fd, const StreamConfig *config, StreamStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!ValidStreamConfig(config)) {
+        return false;
+    }
+
+    Writer w;
+    if (!WriterInit(&w, out_fd, WRITER_CAPACITY)) {
+        return false;
+    }
+    bool Ok = ProcessStream(in, &w, config, stats, NULL);
+    WriterFree(&w);
+    return Ok;
+}
+
+// NOTE: Function that returns whether a loaded checkpoint belongs to the run described by now, reporting the first
+// difference. Output holds the stat of the output file, or NULL if there is none.
+static bool SameCheckpointRun(const char *path, const CheckpointState *saved, const CheckpointState *now,
+                              const struct stat *Output) {
+    if (saved->InputSize != now->InputSize) {
+        fprintf(stderr, "ERROR: Checkpoint %s was written for a different input (size %llu, now %llu)\n",
+                path, (unsigned long long)saved->InputSize, (unsigned long long)now->InputSize);
+        return false;
+    }
+    if (saved->InputMtime != now->InputMtime) {
+        fprintf(stderr, "ERROR: Checkpoint %s was written for a different input (modified since)\n", path);
+        return false;
+    }
+    if (saved->Box != now->Box) {
+        fprintf(stderr, "ERROR: Checkpoint %s was written for Box Size %llu, not %llu\n",
+                path, (unsigned long long)saved->Box, (unsigned long long)now->Box);
+        return false;
+    }
+    if (saved->Backend != now->Backend) {
+        fprintf(stderr, "ERROR: Checkpoint %s was written by the %s Backend, not %s\n",
+                path, saved->Backend <= BACKEND_PORTFOLIO ? BackendName((SolverBackend)saved->Backend) : "unknown",
+                BackendName((SolverBackend)now->Backend));
+        return false;
+    }
+    if (Output == NULL || saved->OutputDevice != (uint64_t)Output->st_dev || saved->OutputInode != (uint64_t)Output->st_ino) {
+        fprintf(stderr, "ERROR: Checkpoint %s was written for a different output file\n", path);
+        return false;
+    }
+    return true;
+}
+
+// NOTE: Function that solves the puzzles of in_path into out_path, checkpointing every `every` batches
+// If checkpoint_path holds a checkpoint from an interrupted run, the input is resumed from the recorded offset
+// and the output is cut back to the recorded offset, so nothing is solved or written twice. A checkpoint of another
+// run (see SameCheckpointRun) is refused and kept, leaving both files untouched.
+// The checkpoint is removed once the run completes.
+bool RunBatch(const char *in_path, const char *out_path, const StreamConfig *config,
+              const char *checkpoint_path, uint64_t every, StreamStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!ValidStreamConfig(config)) {
+        return false;
+    }
+
+    struct stat Info;
+    if (stat(in_path, &Info) != 0) {
+        fprintf(stderr, READ_FILE_FAILED, in_path);
+        return false;
+    }
+
+    CheckpointRun cp;
+    cp.Path = checkpoint_path;
+    cp.Every = every > 0 ? every : CHECKPOINT_EVERY;
+    bool Resume = false;
+    if (checkpoint_path != NULL && !LoadCheckpoint(checkpoint_path, &cp.State, &Resume)) {
+        return false;
+    }
+    CheckpointState Now;
+    memset(&Now, 0, sizeof(Now));
+    Now.InputSize = (uint64_t)Info.st_size;
+    Now.InputMtime = (uint64_t)Info.st_mtim.tv_sec * 1000000000ull + (uint64_t)Info.st_mtim.tv_nsec;
+    Now.Box = (uint64_t)config->Box;
+    Now.Backend = (uint64_t)config->Backend;
+    if (Resume) {
+        struct stat Existing;
+        bool HasOutput = stat(out_path, &Existing) == 0;
+        if (!SameCheckpointRun(checkpoint_path, &cp.State, &Now, HasOutput ? &Existing : NULL)) {
+            return false;
+        }
+    }
+    cp.State.InputSize = Now.InputSize;
+    cp.State.InputMtime = Now.InputMtime;
+    cp.State.Box = Now.Box;
+    cp.State.Backend = Now.Backend;
+
+    FILE *In = fopen(in_path, "r");
+    if (In == NULL) {
+        fprintf(stderr, READ_FILE_FAILED, in_path);
+        return false;
+    }
+    int fd = open(out_path, O_WRONLY | O_CREAT | (Resume ? 0 : O_TRUNC), 0644);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: Failed To Open %s For Writing: %s\n", out_path, strerror(errno));
+        fclose(In);
+        return false;
+    }
+
+    struct stat Output;
+    bool Ok = fstat(fd, &Output) == 0;
+    if (!Ok) {
+        fprintf(stderr, "ERROR: Failed To Stat %s: %s\n", out_path, strerror(errno));
+    } else {
+        cp.State.OutputDevice = (uint64_t)Output.st_dev;
+        cp.State.OutputInode = (uint64_t)Output.st_ino;
+    }
+    if (Resume && Ok) {
+        Ok = fseeko(In, (off_t)cp.State.InputOffset, SEEK_SET) == 0
+             && ftruncate(fd, (off_t)cp.State.OutputOffset) == 0
+             && lseek(fd, (off_t)cp.State.OutputOffset, SEEK_SET) == (off_t)cp.State.OutputOffset;
+        if (!Ok) {
+            fprintf(stderr, "ERROR: Failed To Resume From %s: %s\n", checkpoint_path, strerror(errno));
+        } else {
+            *stats = cp.State.Stats;
+            fprintf(stderr, "[INFO]: Resuming after Puzzle %llu\n", (unsigned long long)stats->Puzzles);
+        }
+    }
+
+    Writer w;
+    Ok = Ok && WriterInit(&w, fd, WRITER_CAPACITY);
+    if (Ok) {
+        Ok = ProcessStream(In, &w, config, stats, checkpoint_path != NULL ? &cp : NULL);
+        WriterFree(&w);
+    }
+    Ok = Ok && fsync(fd) == 0;
+
+    fclose(In);
+    if (close(fd) != 0) Ok = false;
+    if (Ok && checkpoint_path != NULL) {
+        RemoveCheckpoint(checkpoint_path);
+    }
+    return Ok;
+}
+
+// NOTE: Function that solves the puzzles in bytes [start, end) of in_path into out_path (Shard Worker)
+// The range is mapped and read through fmemopen, so the input ends exactly at end. The solutions are written to
+// out_path.tmp and only renamed to out_path once complete, so a crashed worker never leaves a partial shard behind.
+bool RunShard(const char *in_path, uint64_t start, uint64_t end, const char *out_path,
+              const StreamConfig *config, StreamStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!ValidStreamConfig(config) || end < start) {
+        return false;
+    }
+
+    char Tmp[PATH_MAX];
+    if (snprintf(Tmp, sizeof(Tmp), "%s.tmp", out_path) >= (int)sizeof(Tmp)) {
+        fprintf(stderr, "ERROR: Output Path Too Long: %s\n", out_path);
+        return false;
+    }
+    int fd = open(Tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: Failed To Open %s For Writing: %s\n", Tmp, strerror(errno));
+        return false;
+    }
+
+    bool Ok = true;
+    if (end > start) {
+        int in_fd = open(in_path, O_RDONLY);
+        if (in_fd < 0) {
+            fprintf(stderr, READ_FILE_FAILED, in_path);
+            close(fd);
+            return false;
+        }
+        uint64_t Page = (uint64_t)sysconf(_SC_PAGESIZE);
+        uint64_t MapStart = start - start % Page;
+        size_t MapLength = (size_t)(end - MapStart);
+        void *Map = mmap(NULL, MapLength, PROT_READ, MAP_PRIVATE, in_fd, (off_t)MapStart);
+        close(in_fd);
+        FILE *In = Map == MAP_FAILED ? NULL : fmemopen((char *)Map + (start - MapStart), (size_t)(end - start), "r");
+        if (In == NULL) {
+            fprintf(stderr, "ERROR: Failed To Map Bytes %llu-%llu of %s: %s\n", (unsigned long long)start,
+                    (unsigned long long)end, in_path, strerror(errno));
+            Ok = false;
+        } else {
+            Writer w;
+            Ok = WriterInit(&w, fd, WRITER_CAPACITY);
+            if (Ok) {
+                Ok = ProcessStream(In, &w, config, stats, NULL);
+                WriterFree(&w);
+            }
+            fclose(In);
+        }
+        if (Map != MAP_FAILED) munmap(Map, MapLength);
+    }
+
+    Ok = Ok && fsync(fd) == 0;
+    if (close(fd) != 0) Ok = false;
+    if (Ok && rename(Tmp, out_path) != 0) {
+        fprintf(stderr, "ERROR: Failed To Rename %s: %s\n", Tmp, strerror(errno));
+        Ok = false;
+    }
+    if (!Ok) {
+        remove(Tmp);
+    }
+    return Ok;
+}
@@ -0,0 +1,73 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "sudoku.h"
+#include "batch.h"
+#include "perf.h"
+#include "schedule.h"
+
+// NOTE: Streaming Pipeline Sizes
+// At most STREAM_BATCH puzzles (SCHEDULE_WINDOW batches with --jobs) are in flight at once and output is written
+// in WRITER_CAPACITY chunks, so memory use does not depend on the length of the input.
+#define STREAM_BATCH 256
+#define WRITER_CAPACITY (1 << 20)
+#define PUZZLE_LINE_SIZE (BOARD_CELLS + 1)
+#define MALFORMED_LINE "ERROR\n"   // Output line of an input record that is not a puzzle
+
+typedef enum {
+    BACKEND_SEARCH,     // Recursive Backtracking Search (9x9 only)
+    BACKEND_SAT,        // CDCL SAT Backend (any box size up to SAT_MAX_BOX)
+    BACKEND_BATCH,      // Lockstep SIMD propagation with Search for the rest (9x9 only)
+    BACKEND_PORTFOLIO,  // Several search strategies racing on their own threads (9x9 only)
+} SolverBackend;
+
+typedef struct {
+    SolverBackend Backend;  // Backend whose solutions are written out
+    int Box;                // Box size of the input boards (3 for 9x9)
+    bool Check;             // Also solve with the other backend and verify both results
+    int Threads;            // Portfolio members per puzzle
+    const PerfCounters *Counters;   // Counters to read around loading and solving (NULL for none)
+    ScheduleConfig Schedule;        // Solver threads and start order (9x9 only)
+} StreamConfig;
+
+// Buffered Writer over a raw file descriptor; write(2) blocks when the consumer is slow
+typedef struct {
+    int fd;
+    char *buf;
+    size_t count;
+    size_t capacity;
+} Writer;
+
+typedef struct {
+    uint64_t Puzzles;   // Puzzles read from the input
+    uint64_t Solved;    // Puzzles written out solved
+    uint64_t Failed;    // Puzzles that had no solution (written out unchanged)
+    uint64_t Malformed; // Input records that are not puzzles (written out as MALFORMED_LINE)
+    uint64_t Mismatched;// Puzzles where the backends disagreed or a solution failed CheckSolution
+    BatchStats Batch;   // Breakdown of the Batch Backend
+    PerfSample Load;    // Time and counters spent reading puzzles
+    PerfSample Solve;   // Time and counters spent in the backend
+    ScheduleStats Schedule; // Per-class latency when Schedule.Workers > 0
+} StreamStats;
+
+bool WriterInit(Writer *w, int fd, size_t capacity);
+bool WriterPut(Writer *w, const char *data, size_t n);
+bool WriterFlush(Writer *w);
+void WriterFree(Writer *w);
+bool WritePuzzleLine(Writer *w, const int Values[BOARD_CELLS]);
+bool WritePuzzleLineN(Writer *w, const int *Values, int box);
+const char *BackendName(SolverBackend backend);
+bool ValidStreamConfig(const StreamConfig *config);
+bool SolveWithBackend(const StreamConfig *config, SolverBackend backend, int *Values);
+void SolveManyWithBackend(const StreamConfig *config, int *Values, int count, bool *Solved, BatchStats *stats);
+bool RunStream(FILE *in, int out_fd, const StreamConfig *config, StreamStats *stats);
+bool RunBatch(const char *in_path, const char *out_path, const StreamConfig *config,
+              const char *checkpoint_path, uint64_t every, StreamStats *stats);
+bool RunShard(const char *in_path, uint64_t start, uint64_t end, const char *out_path,
+              const StreamConfig *config, StreamStats *stats);
+
+#endif // STREAM_H
@@ -1,9 +1,10 @@
 #include "sudoku.h"
 
 // NOTE: Function to Initialize the Board and Populate it with Values Read from the Grid
+// Lines after the first BOARD_ROWS describe a variant (see variants.h) and are ignored here.
 void InitBoard(Grid *g, CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
-    assert(BOARD_ROWS == g->count && BOARD_COLS == g->items[0]->count);
-    for (int i = 0; i < (int)g->count; ++i) {
+    assert(BOARD_ROWS <= g->count && BOARD_COLS == g->items[0]->count);
+    for (int i = 0; i < BOARD_ROWS; ++i) {
         for (int j = 0; j < (int) g->items[0]->count; ++j) {
             int n = g->items[i]->buf[j] - '0';
             if (n == EMPTY) {
@@ -16,6 +17,30 @@ void InitBoard(Grid *g, CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
     }
 }
 
+// NOTE: Function to Initialize the Board from a flat row-major array of Values (0 = Empty)
+void LoadBoard(const int Values[BOARD_CELLS], CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            int n = Values[i * BOARD_COLS + j];
+            if (n == EMPTY) {
+                _Board[i][j].occupied = false;
+                _Board[i][j].cell = NULL;
+            } else {
+                SetCell(_Board, i , j , n);
+            }
+        }
+    }
+}
+
+// NOTE: Function to copy the Board into a flat row-major array of Values (0 = Empty)
+void StoreBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS], int Values[BOARD_CELLS]) {
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            Values[i * BOARD_COLS + j] = CheckCellStatus(_Board, i , j) ? GetCell(_Board, i , j)->value : EMPTY;
+        }
+    }
+}
+
 // NOTE: Function to Check Whether a cell from the Board is Occupied or Not
 bool CheckCellStatus(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col) {
     if (_Board[row][col].occupied && _Board[row][col].cell != NULL) {
@@ -41,81 +66,99 @@ Cell *GetCell(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col) {
 }
 
 // NOTE: Function to print the Board in the terminal
+// The whole Board is formatted into one buffer and written with a single call.
 void PrintBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
+    char Buffer[(BOARD_ROWS * 2 + 1) * (BOARD_COLS * 4 + 3)];
+    size_t Count = 0;
+
     // Print the top border of the board
-    printf("+");
+    Buffer[Count++] = '+';
     for (int i = 0; i < BOARD_COLS; ++i) {
-        printf("----");
+        memcpy(Buffer + Count, "----", 4);
+        Count += 4;
     }
-    printf("+\n");
+    Buffer[Count++] = '+';
+    Buffer[Count++] = '\n';
 
     // Print each row of the board
     for (int i = 0; i < BOARD_ROWS; ++i) {
         for (int j = 0; j < BOARD_COLS; ++j) {
-            if (_Board[i][j].occupied) {
-                printf("| %d ", _Board[i][j].cell->value);
-            } else {
-                printf("| 0 ");
-            }
+            int Value = _Board[i][j].occupied ? _Board[i][j].cell->value : EMPTY;
+            Buffer[Count++] = '|';
+            Buffer[Count++] = ' ';
+            Buffer[Count++] = (char)('0' + Value);
+            Buffer[Count++] = ' ';
         }
-        printf("|\n");
+        Buffer[Count++] = '|';
+        Buffer[Count++] = '\n';
 
         // Print the row separator
-        printf("+");
+        Buffer[Count++] = '+';
         for (int j = 0; j < BOARD_COLS; ++j) {
-            printf("----");
+            memcpy(Buffer + Count, "----", 4);
+            Count += 4;
         }
-        printf("+\n");
+        Buffer[Count++] = '+';
+        Buffer[Count++] = '\n';
     }
+    fwrite(Buffer, 1, Count, stdout);
 }
 
-// NOTE: Funtion that Return Whether the Board is Valid or Not
-bool ValidBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
-    // Check for duplicates in Columns
+// NOTE: Funtion that Return Whether the Givens are Valid or Not
+// Empty Cells are ignored, so a partially filled Board is Valid as long as no Row, Column or Sub-Grid repeats a value.
+bool ValidGivens(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
+    int GRID = sqrt(BOARD_ROWS);
+
     for (int i = 0; i < BOARD_ROWS; ++i) {
-        for (int j = 0; j < BOARD_COLS - 1; ++j) {
-            if (_Board[i][j].occupied && _Board[i][j + 1].occupied) {
-                if (GetCell(_Board, i , j)->value == GetCell(_Board, i , j + 1)->value) {
+        bool RowSeen[BOARD_COLS + 1] = {false};
+        bool ColSeen[BOARD_ROWS + 1] = {false};
+        bool SubGridSeen[BOARD_COLS + 1] = {false};
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            // Check for duplicates in Rows
+            if (CheckCellStatus(_Board, i , j)) {
+                int CurrentValue = GetCell(_Board, i , j)->value;
+                if (RowSeen[CurrentValue]) {
                     return false;
                 }
+                RowSeen[CurrentValue] = true;
             }
-        }
-    }
 
-    // Check for duplicates in Rows
-    for (int i = 0; i < BOARD_ROWS - 1; ++i) {
-        for (int j = 0; j < BOARD_COLS; ++j) {
-            if (_Board[i][j].occupied && _Board[i + 1][j].occupied) {
-                if (GetCell(_Board, i , j)->value == GetCell(_Board, i + 1, j)->value) {
+            // Check for duplicates in Columns (cell j of Column i)
+            if (CheckCellStatus(_Board, j , i)) {
+                int CurrentValue = GetCell(_Board, j , i)->value;
+                if (ColSeen[CurrentValue]) {
                     return false;
                 }
+                ColSeen[CurrentValue] = true;
             }
-        }
-    }
 
-    // Check for duplicates in the Sub-Grids
-    for (int m = 0; m < BOARD_ROWS; ++m) {
-        for (int n = 0; n < BOARD_COLS; ++n) {
-            for (int i = 0; i < 3; ++i) {
-                for (int j = 0; j < 3; ++j) {
-                    if (_Board[i + m][j + n].occupied) {
-                        int CurrentValue = GetCell(_Board, i + m , n + j)->value;
-                        for (int x = 0; x < 3; ++x) {
-                            for (int y = 0; y < 3; ++y) {
-                                if (x == i && y == j) continue;
-                                if(_Board[x + m][y + n].occupied && GetCell(_Board, x + m , y + n)->value == CurrentValue) {
-                                    return false;
-                                }
-                            }
-                        }
-                    }
+            // Check for duplicates in the Sub-Grids (cell j of Sub-Grid i)
+            int Row = (i / GRID) * GRID + j / GRID;
+            int Col = (i % GRID) * GRID + j % GRID;
+            if (CheckCellStatus(_Board, Row , Col)) {
+                int CurrentValue = GetCell(_Board, Row , Col)->value;
+                if (SubGridSeen[CurrentValue]) {
+                    return false;
                 }
+                SubGridSeen[CurrentValue] = true;
             }
         }
     }
     return true;
 }
 
+// NOTE: Funtion that Return Whether the Board is Valid or Not: every Cell filled and no value repeated
+bool ValidBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            if (!CheckCellStatus(_Board, i , j)) {
+                return false;
+            }
+        }
+    }
+    return ValidGivens(_Board);
+}
+
 // NOTE: Functions that return an array  of potential Candidates for a cell in the Board
 int *GetCandidates(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col, int *count) {
     int *Candidates = (int *)malloc(sizeof(int) * BOARD_COLS*1);
@@ -179,12 +222,9 @@ int *GetCandidates(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col, i
     return ValidCandidates;
 }
 
-// NOTE: Function that Solves the board recursively
-bool Search(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
-    if (ValidBoard(_Board)) {
-        return true;
-    }
-
+// NOTE: Function that fills the Empty Cells recursively, the Board is solved once none is left
+// Candidates never conflict with the Board, so only the givens need checking (see Search).
+static bool Backtrack(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
     for (int i = 0; i < BOARD_ROWS; ++i) {
         for (int j = 0; j < BOARD_COLS; ++j) {
             if(!CheckCellStatus(_Board, i , j)) {
@@ -193,7 +233,7 @@ bool Search(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
                 for (int k = 0; k < Count; ++k) {
                     SetCell(_Board, i , j , Candidates[k]);
 
-                    bool IsSolved = Search(_Board);
+                    bool IsSolved = Backtrack(_Board);
                     if(IsSolved) {
                         if (Candidates != NULL) {
                             free(Candidates);
@@ -215,6 +255,45 @@ bool Search(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
     return true;
 }
 
+// NOTE: Function that Solves the board recursively, conflicting givens fail right away
+bool Search(CellPool _Board[BOARD_ROWS][BOARD_COLS]) {
+    if (!ValidGivens(_Board)) {
+        return false;
+    }
+    return Backtrack(_Board);
+}
+
+// NOTE: Function that Solves a flat row-major array of Values in place
+bool SolveValues(int Values[BOARD_CELLS]) {
+    CellPool _Board[BOARD_ROWS][BOARD_COLS];
+    LoadBoard(Values, _Board);
+    bool Solved = Search(_Board);
+    if (Solved) {
+        StoreBoard(_Board, Values);
+    }
+    FreeBoard(_Board);
+    return Solved;
+}
+
+// NOTE: Function that checks a complete Solution of box x box boxes against the Puzzle it came from
+bool CheckSolution(const int *Puzzle, const int *Solution, int box) {
+    int N = box * box;
+    uint32_t Full = (N >= 32) ? 0xFFFFFFFFu : ((1u << N) - 1u);
+    for (int a = 0; a < N; ++a) {
+        uint32_t Row = 0, Col = 0, Box = 0;
+        for (int i = 0; i < N; ++i) {
+            int Cell = a * N + i;
+            if (Solution[Cell] < 1 || Solution[Cell] > N) return false;
+            if (Puzzle[Cell] != EMPTY && Puzzle[Cell] != Solution[Cell]) return false;
+            Row |= 1u << (Solution[Cell] - 1);
+            Col |= 1u << (Solution[i * N + a] - 1);
+            Box |= 1u << (Solution[((a / box) * box + i / box) * N + (a % box) * box + i % box] - 1);
+        }
+        if (Row != Full || Col != Full || Box != Full) return false;
+    }
+    return true;
+}
+
 // NOTE: Function that frees a cell
 void FreeCell(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col) {
     free(_Board[row][col].cell);
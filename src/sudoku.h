@@ -9,6 +9,7 @@
 
 #define BOARD_ROWS 9
 #define BOARD_COLS BOARD_ROWS
+#define BOARD_CELLS (BOARD_ROWS * BOARD_COLS)
 #define EMPTY 0
 
 typedef struct {
@@ -21,13 +22,18 @@ typedef struct {
 } CellPool;
 
 void InitBoard(Grid *g, CellPool _Board[BOARD_ROWS][BOARD_COLS]);
+void LoadBoard(const int Values[BOARD_CELLS], CellPool _Board[BOARD_ROWS][BOARD_COLS]);
+void StoreBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS], int Values[BOARD_CELLS]);
 bool CheckCellStatus(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col);
 void SetCell(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col , int value);
 Cell *GetCell(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col);
 void PrintBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS]);
 bool ValidBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS]);
+bool ValidGivens(CellPool _Board[BOARD_ROWS][BOARD_COLS]);
 int *GetCandidates(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col, int *count);
 bool Search(CellPool _Board[BOARD_ROWS][BOARD_COLS]);
+bool SolveValues(int Values[BOARD_CELLS]);
+bool CheckSolution(const int *Puzzle, const int *Solution, int box);
 void FreeCell(CellPool _Board[BOARD_ROWS][BOARD_COLS], int row , int col);
 void FreeBoard(CellPool _Board[BOARD_ROWS][BOARD_COLS]);
 
@@ -0,0 +1,376 @@
+#include "variants.h"
+
+#define VARIANT_INLINE static inline __attribute__((always_inline))
+#define DIGIT_BIT(value) ((uint16_t)(1u << ((value) - 1)))
+
+const char *VariantName(VariantKind kind) {
+    switch (kind) {
+    case VARIANT_CLASSIC: return "classic";
+    case VARIANT_DIAGONAL: return "diagonal";
+    case VARIANT_JIGSAW: return "jigsaw";
+    case VARIANT_EVEN_ODD: return "evenodd";
+    case VARIANT_KILLER: return "killer";
+    }
+    return "unknown";
+}
+
+// NOTE: Function that sets up rules without any variant constraint
+void ClassicRules(VariantRules *rules) {
+    memset(rules, 0, sizeof(*rules));
+    rules->Kind = VARIANT_CLASSIC;
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        rules->Region[c] = (uint8_t)BOX_OF(c / BOARD_COLS, c % BOARD_COLS);
+        rules->Allowed[c] = DIGIT_MASK;
+    }
+}
+
+/* Constraint Hooks, always called with a constant kind */
+
+VARIANT_INLINE int RegionOf(const VariantRules *r, int cell, VariantKind kind) {
+    if (kind == VARIANT_JIGSAW) return r->Region[cell];
+    return BOX_OF(cell / BOARD_COLS, cell % BOARD_COLS);
+}
+
+VARIANT_INLINE void Place(VariantBoard *b, const VariantRules *r, int cell, int value, VariantKind kind) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    uint16_t Bit = DIGIT_BIT(value);
+    b->Values[cell] = value;
+    b->Row[Row] |= Bit;
+    b->Col[Col] |= Bit;
+    b->Region[RegionOf(r, cell, kind)] |= Bit;
+    if (kind == VARIANT_DIAGONAL) {
+        if (Row == Col) b->Diag[0] |= Bit;
+        if (Row + Col == BOARD_COLS - 1) b->Diag[1] |= Bit;
+    }
+    if (kind == VARIANT_KILLER) {
+        int k = r->Cage[cell];
+        b->CageUsed[k] |= Bit;
+        b->CageFilled[k]++;
+        b->CageTotal[k] += value;
+    }
+}
+
+VARIANT_INLINE void Clear(VariantBoard *b, const VariantRules *r, int cell, VariantKind kind) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    int Value = b->Values[cell];
+    uint16_t Keep = (uint16_t)~DIGIT_BIT(Value);
+    b->Values[cell] = EMPTY;
+    b->Row[Row] &= Keep;
+    b->Col[Col] &= Keep;
+    b->Region[RegionOf(r, cell, kind)] &= Keep;
+    if (kind == VARIANT_DIAGONAL) {
+        if (Row == Col) b->Diag[0] &= Keep;
+        if (Row + Col == BOARD_COLS - 1) b->Diag[1] &= Keep;
+    }
+    if (kind == VARIANT_KILLER) {
+        int k = r->Cage[cell];
+        b->CageUsed[k] &= Keep;
+        b->CageFilled[k]--;
+        b->CageTotal[k] -= Value;
+    }
+}
+
+// NOTE: Function that keeps the candidates of a Killer cage cell that still leave a reachable cage sum
+// After placing d, the Left remaining cells must add up to the rest of the sum using distinct unused digits.
+static uint16_t PruneCage(const VariantBoard *b, const VariantRules *r, int k, uint16_t candidates) {
+    int Left = r->CageSize[k] - b->CageFilled[k] - 1;
+    int Remaining = r->CageSum[k] - b->CageTotal[k];
+    uint16_t Result = 0;
+    for (uint16_t m = candidates; m; m &= (uint16_t)(m - 1)) {
+        int d = __builtin_ctz(m) + 1;
+        int Rest = Remaining - d;
+        uint16_t Free = (uint16_t)(~(b->CageUsed[k] | DIGIT_BIT(d)) & DIGIT_MASK);
+        if (Left == 0 ? Rest != 0 : Rest <= 0 || __builtin_popcount(Free) < Left) {
+            continue;
+        }
+        int Min = 0, Max = 0;
+        uint16_t Low = Free, High = Free;
+        for (int i = 0; i < Left; ++i) {
+            Min += __builtin_ctz(Low) + 1;
+            Low &= (uint16_t)(Low - 1);
+            int Top = 31 - __builtin_clz(High);
+            Max += Top + 1;
+            High &= (uint16_t)~(1u << Top);
+        }
+        if (Min <= Rest && Rest <= Max) {
+            Result |= DIGIT_BIT(d);
+        }
+    }
+    return Result;
+}
+
+VARIANT_INLINE uint16_t Candidates(const VariantBoard *b, const VariantRules *r, int cell, VariantKind kind) {
+    int Row = cell / BOARD_COLS, Col = cell % BOARD_COLS;
+    uint16_t Used = b->Row[Row] | b->Col[Col] | b->Region[RegionOf(r, cell, kind)];
+    if (kind == VARIANT_DIAGONAL) {
+        if (Row == Col) Used |= b->Diag[0];
+        if (Row + Col == BOARD_COLS - 1) Used |= b->Diag[1];
+    }
+    uint16_t Result = (uint16_t)(~Used & DIGIT_MASK);
+    if (kind == VARIANT_EVEN_ODD) {
+        Result &= r->Allowed[cell];
+    }
+    if (kind == VARIANT_KILLER) {
+        int k = r->Cage[cell];
+        Result = PruneCage(b, r, k, (uint16_t)(Result & ~b->CageUsed[k]));
+    }
+    return Result;
+}
+
+/* Solver Body, instantiated once per VariantKind */
+
+typedef bool (*VariantSolver)(VariantBoard *b, const VariantRules *r);
+
+// Board and Rules handed to the candidate function of PickFewestCandidates
+typedef struct {
+    const VariantBoard *Board;
+    const VariantRules *Rules;
+} VariantView;
+
+// NOTE: Depth-first search that branches on the cell with the fewest candidates; Recurse is the instance itself
+// and CandidatesOf its candidate function, both bound to the same constant kind
+VARIANT_INLINE bool SolveBody(VariantBoard *b, const VariantRules *r, VariantKind kind, VariantSolver Recurse,
+                              CellCandidates CandidatesOf) {
+    VariantView View = { b, r };
+    uint16_t BestCandidates = 0;
+    int Best = PickFewestCandidates(b->Values, CandidatesOf, &View, false, &BestCandidates);
+    if (Best == CELL_DEAD_END) {
+        return false;
+    }
+    if (Best == CELL_NONE) {
+        return true;
+    }
+
+    while (BestCandidates) {
+        int Value = __builtin_ctz(BestCandidates) + 1;
+        BestCandidates &= (uint16_t)(BestCandidates - 1);
+        Place(b, r, Best, Value, kind);
+        if (Recurse(b, r)) {
+            return true;
+        }
+        Clear(b, r, Best, kind);
+    }
+    return false;
+}
+
+// NOTE: Function that loads Values into the Board, returns false if a given breaks a rule of the variant
+VARIANT_INLINE bool InitBody(VariantBoard *b, const VariantRules *r, const int Values[BOARD_CELLS], VariantKind kind) {
+    memset(b, 0, sizeof(*b));
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        if (Values[c] == EMPTY) continue;
+        if (Values[c] < 1 || Values[c] > BOARD_COLS || !(Candidates(b, r, c, kind) & DIGIT_BIT(Values[c]))) {
+            return false;
+        }
+        Place(b, r, c, Values[c], kind);
+    }
+    return true;
+}
+
+#define VARIANT_INSTANCE(Name, KIND)                                                            \
+    static uint16_t Candidates##Name(const void *view, int cell) {                              \
+        const VariantView *v = (const VariantView *)view;                                       \
+        return Candidates(v->Board, v->Rules, cell, KIND);                                      \
+    }                                                                                           \
+    static bool Solve##Name(VariantBoard *b, const VariantRules *r) {                           \
+        return SolveBody(b, r, KIND, Solve##Name, Candidates##Name);                            \
+    }                                                                                           \
+    static bool Init##Name(VariantBoard *b, const VariantRules *r, const int Values[BOARD_CELLS]) { \
+        return InitBody(b, r, Values, KIND);                                                    \
+    }
+
+VARIANT_INSTANCE(Classic, VARIANT_CLASSIC)
+VARIANT_INSTANCE(Diagonal, VARIANT_DIAGONAL)
+VARIANT_INSTANCE(Jigsaw, VARIANT_JIGSAW)
+VARIANT_INSTANCE(EvenOdd, VARIANT_EVEN_ODD)
+VARIANT_INSTANCE(Killer, VARIANT_KILLER)
+
+// NOTE: Function that solves Values in place under the rules; on failure Values is left untouched
+bool VariantSolveValues(int Values[BOARD_CELLS], const VariantRules *rules) {
+    VariantBoard b;
+    bool Solved = false;
+    switch (rules->Kind) {
+    case VARIANT_CLASSIC: Solved = InitClassic(&b, rules, Values) && SolveClassic(&b, rules); break;
+    case VARIANT_DIAGONAL: Solved = InitDiagonal(&b, rules, Values) && SolveDiagonal(&b, rules); break;
+    case VARIANT_JIGSAW: Solved = InitJigsaw(&b, rules, Values) && SolveJigsaw(&b, rules); break;
+    case VARIANT_EVEN_ODD: Solved = InitEvenOdd(&b, rules, Values) && SolveEvenOdd(&b, rules); break;
+    case VARIANT_KILLER: Solved = InitKiller(&b, rules, Values) && SolveKiller(&b, rules); break;
+    }
+    if (Solved) {
+        memcpy(Values, b.Values, sizeof(b.Values));
+    }
+    return Solved;
+}
+
+// NOTE: Function that checks a complete Solution against its Puzzle and every rule of the variant
+bool VariantCheckSolution(const int Puzzle[BOARD_CELLS], const int Solution[BOARD_CELLS], const VariantRules *rules) {
+    uint16_t Row[BOARD_ROWS] = {0}, Col[BOARD_COLS] = {0}, Region[BOARD_ROWS] = {0}, Diag[2] = {0};
+    int CageTotal[VARIANT_MAX_CAGES] = {0};
+    uint16_t CageUsed[VARIANT_MAX_CAGES] = {0};
+    for (int c = 0; c < BOARD_CELLS; ++c) {
+        int Value = Solution[c];
+        if (Value < 1 || Value > BOARD_COLS) return false;
+        if (Puzzle[c] != EMPTY && Puzzle[c] != Value) return false;
+        if (!(rules->Allowed[c] & DIGIT_BIT(Value))) return false;
+
+        int r = c / BOARD_COLS, k = c % BOARD_COLS;
+        Row[r] |= DIGIT_BIT(Value);
+        Col[k] |= DIGIT_BIT(Value);
+        Region[rules->Region[c]] |= DIGIT_BIT(Value);
+        if (r == k) Diag[0] |= DIGIT_BIT(Value);
+        if (r + k == BOARD_COLS - 1) Diag[1] |= DIGIT_BIT(Value);
+        if (rules->Kind == VARIANT_KILLER) {
+            int Cage = rules->Cage[c];
+            if (CageUsed[Cage] & DIGIT_BIT(Value)) return false;
+            CageUsed[Cage] |= DIGIT_BIT(Value);
+            CageTotal[Cage] += Value;
+        }
+    }
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        if (Row[i] != DIGIT_MASK || Col[i] != DIGIT_MASK || Region[i] != DIGIT_MASK) return false;
+    }
+    if (rules->Kind == VARIANT_DIAGONAL && (Diag[0] != DIGIT_MASK || Diag[1] != DIGIT_MASK)) {
+        return false;
+    }
+    for (int k = 0; rules->Kind == VARIANT_KILLER && k < rules->CageCount; ++k) {
+        if (CageTotal[k] != rules->CageSum[k]) return false;
+    }
+    return true;
+}
+
+/* Loading from the Grid File */
+
+// NOTE: Function that copies a Grid line into a NUL terminated buffer, dropping trailing white space
+static void GridLine(Grid *g, size_t i, char *out, size_t size) {
+    size_t n = g->items[i]->count < size - 1 ? g->items[i]->count : size - 1;
+    memcpy(out, g->items[i]->buf, n);
+    while (n > 0 && (out[n - 1] == ' ' || out[n - 1] == '\t' || out[n - 1] == '\r')) --n;
+    out[n] = '\0';
+}
+
+// NOTE: Function that reads 9 lines of one symbol per cell starting at line first, numbering symbols by first use
+static bool ReadCellSymbols(Grid *g, size_t first, uint8_t Index[BOARD_CELLS], char Symbols[BOARD_CELLS], int *count) {
+    if (g->count < first + BOARD_ROWS) {
+        fprintf(stderr, "ERROR: Expected %d more Lines in the Grid\n", BOARD_ROWS);
+        return false;
+    }
+    *count = 0;
+    char Line[MAX_LINE_COUNT];
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        GridLine(g, first + i, Line, sizeof(Line));
+        if ((int)strlen(Line) != BOARD_COLS) {
+            fprintf(stderr, "ERROR: Line %zu of the Grid must have %d Cells\n", first + i + 1, BOARD_COLS);
+            return false;
+        }
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            int s = 0;
+            while (s < *count && Symbols[s] != Line[j]) ++s;
+            if (s == *count) Symbols[(*count)++] = Line[j];
+            Index[i * BOARD_COLS + j] = (uint8_t)s;
+        }
+    }
+    return true;
+}
+
+static bool LoadJigsaw(Grid *g, VariantRules *rules) {
+    char Symbols[BOARD_CELLS];
+    int Count;
+    if (!ReadCellSymbols(g, BOARD_ROWS + 1, rules->Region, Symbols, &Count)) {
+        return false;
+    }
+    int Size[BOARD_CELLS] = {0};
+    for (int c = 0; c < BOARD_CELLS; ++c) Size[rules->Region[c]]++;
+    bool Ok = Count == BOARD_ROWS;
+    for (int s = 0; Ok && s < Count; ++s) Ok = Size[s] == BOARD_COLS;
+    if (!Ok) {
+        fprintf(stderr, "ERROR: A Jigsaw needs %d Regions of %d Cells\n", BOARD_ROWS, BOARD_COLS);
+    }
+    return Ok;
+}
+
+static bool LoadEvenOdd(Grid *g, VariantRules *rules) {
+    if (g->count < 2 * BOARD_ROWS + 1) {
+        fprintf(stderr, "ERROR: Expected %d more Lines in the Grid\n", BOARD_ROWS);
+        return false;
+    }
+    char Line[MAX_LINE_COUNT];
+    for (int i = 0; i < BOARD_ROWS; ++i) {
+        GridLine(g, BOARD_ROWS + 1 + i, Line, sizeof(Line));
+        if ((int)strlen(Line) != BOARD_COLS) {
+            fprintf(stderr, "ERROR: Line %d of the Grid must have %d Cells\n", BOARD_ROWS + 2 + i, BOARD_COLS);
+            return false;
+        }
+        for (int j = 0; j < BOARD_COLS; ++j) {
+            char s = Line[j];
+            uint16_t *Allowed = &rules->Allowed[i * BOARD_COLS + j];
+            if (s == 'E' || s == 'e') *Allowed = EVEN_DIGITS;
+            else if (s == 'O' || s == 'o') *Allowed = ODD_DIGITS;
+            else if (s == '.' || s == '0') *Allowed = DIGIT_MASK;
+            else {
+                fprintf(stderr, "ERROR: Unknown Even/Odd Symbol '%c'\n", s);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool LoadKiller(Grid *g, VariantRules *rules) {
+    char Symbols[BOARD_CELLS];
+    if (!ReadCellSymbols(g, BOARD_ROWS + 1, rules->Cage, Symbols, &rules->CageCount)) {
+        return false;
+    }
+    for (int c = 0; c < BOARD_CELLS; ++c) rules->CageSize[rules->Cage[c]]++;
+
+    bool HasSum[VARIANT_MAX_CAGES] = {false};
+    char Line[MAX_LINE_COUNT];
+    for (size_t i = 2 * BOARD_ROWS + 1; i < g->count; ++i) {
+        GridLine(g, i, Line, sizeof(Line));
+        char Symbol;
+        int Sum;
+        if (sscanf(Line, " %c %d", &Symbol, &Sum) != 2) {
+            fprintf(stderr, "ERROR: Expected \"SYMBOL SUM\" on Line %zu of the Grid\n", i + 1);
+            return false;
+        }
+        int k = 0;
+        while (k < rules->CageCount && Symbols[k] != Symbol) ++k;
+        if (k == rules->CageCount) {
+            fprintf(stderr, "ERROR: Sum given for unknown Cage '%c'\n", Symbol);
+            return false;
+        }
+        rules->CageSum[k] = Sum;
+        HasSum[k] = true;
+    }
+    for (int k = 0; k < rules->CageCount; ++k) {
+        if (!HasSum[k] || rules->CageSize[k] > BOARD_COLS) {
+            fprintf(stderr, "ERROR: Cage '%c' needs a Sum and at most %d Cells\n", Symbols[k], BOARD_COLS);
+            return false;
+        }
+    }
+    return true;
+}
+
+// NOTE: Function that reads the variant description that follows the 9 grid lines (a plain grid is Classic)
+bool LoadVariant(Grid *g, VariantRules *rules) {
+    ClassicRules(rules);
+    if (g->count <= BOARD_ROWS) {
+        return true;
+    }
+
+    char Name[MAX_LINE_COUNT];
+    GridLine(g, BOARD_ROWS, Name, sizeof(Name));
+    if (strcmp(Name, "diagonal") == 0) {
+        rules->Kind = VARIANT_DIAGONAL;
+        return true;
+    } else if (strcmp(Name, "jigsaw") == 0) {
+        rules->Kind = VARIANT_JIGSAW;
+        return LoadJigsaw(g, rules);
+    } else if (strcmp(Name, "evenodd") == 0) {
+        rules->Kind = VARIANT_EVEN_ODD;
+        return LoadEvenOdd(g, rules);
+    } else if (strcmp(Name, "killer") == 0) {
+        rules->Kind = VARIANT_KILLER;
+        return LoadKiller(g, rules);
+    }
+    fprintf(stderr, "ERROR: Unknown Variant \"%s\"\n", Name);
+    return false;
+}
@@ -0,0 +1,60 @@
+#ifndef VARIANTS_H
+#define VARIANTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sudoku.h"
+#include "masks.h"
+
+// NOTE: Sudoku Variants
+// Every variant is a constraint plugin with three hooks: Place / Clear keep its own masks in step with the Board,
+// and Prune removes the candidates its rules forbid. The solver body is always inlined into one function per
+// variant with the VariantKind as a constant, so the hooks of the other variants fold away at compile time and
+// the classic instance is a plain Row / Column / Box bitmask search.
+//
+// A variant grid file is a normal 9 line grid followed by the variant name and its description:
+//   diagonal    no further lines; both main diagonals hold every digit once
+//   jigsaw      9 lines giving each cell a region symbol (nine cells per region) that replaces the 3x3 boxes
+//   evenodd     9 lines of 'E' (even), 'O' (odd) or '.' (any) per cell
+//   killer      9 lines giving each cell a cage symbol, then one "SYMBOL SUM" line per cage;
+//               the digits of a cage are distinct and add up to SUM
+#define VARIANT_MAX_CAGES BOARD_CELLS
+#define EVEN_DIGITS 0x0AA   // 2, 4, 6, 8
+#define ODD_DIGITS 0x155    // 1, 3, 5, 7, 9
+
+typedef enum {
+    VARIANT_CLASSIC,
+    VARIANT_DIAGONAL,
+    VARIANT_JIGSAW,
+    VARIANT_EVEN_ODD,
+    VARIANT_KILLER,
+} VariantKind;
+
+typedef struct {
+    VariantKind Kind;
+    uint8_t Region[BOARD_CELLS];        // Jigsaw: region of each cell (the 3x3 box for the other variants)
+    uint16_t Allowed[BOARD_CELLS];      // Even/Odd: digits allowed in each cell
+    uint8_t Cage[BOARD_CELLS];          // Killer: cage of each cell
+    uint8_t CageSize[VARIANT_MAX_CAGES];
+    int CageSum[VARIANT_MAX_CAGES];
+    int CageCount;
+} VariantRules;
+
+typedef struct {
+    int Values[BOARD_CELLS];
+    uint16_t Row[BOARD_ROWS];
+    uint16_t Col[BOARD_COLS];
+    uint16_t Region[BOARD_ROWS];
+    uint16_t Diag[2];                   // Diagonal: main diagonal and anti-diagonal
+    uint16_t CageUsed[VARIANT_MAX_CAGES];   // Killer: digits placed in each cage
+    uint8_t CageFilled[VARIANT_MAX_CAGES];
+    int CageTotal[VARIANT_MAX_CAGES];
+} VariantBoard;
+
+const char *VariantName(VariantKind kind);
+void ClassicRules(VariantRules *rules);
+bool LoadVariant(Grid *g, VariantRules *rules);
+bool VariantSolveValues(int Values[BOARD_CELLS], const VariantRules *rules);
+bool VariantCheckSolution(const int Puzzle[BOARD_CELLS], const int Solution[BOARD_CELLS], const VariantRules *rules);
+
+#endif // VARIANTS_H
@@ -0,0 +1,25 @@
+# NOTE: Helpers shared by the tests/test_*.sh scripts (sourced, run from inside WORK)
+set -u
+
+fail() {
+    echo "FAIL: $*" >&2
+    exit 1
+}
+
+# Runs MAIN with the given arguments (stdin is passed on) and fails unless it exits with the expected status;
+# its stdout and stderr are left in the files out and err
+expect_exit() {
+    Expected=$1
+    shift
+    "$MAIN" "$@" > out 2> err
+    Status=$?
+    if [ "$Status" -ne "$Expected" ]; then
+        cat err >&2
+        fail "main $* exited with $Status, expected $Expected"
+    fi
+}
+
+# Fails unless the two files are byte for byte the same
+expect_same() {
+    cmp -s "$1" "$2" || fail "$3: $1 differs from $2"
+}
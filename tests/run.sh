@@ -0,0 +1,41 @@
+#!/bin/sh
+# NOTE: Regression Tests
+# Usage: sh tests/run.sh [MAIN]   (MAIN is the terminal binary, ./main by default; `make test` builds nothing)
+# Every tests/test_*.sh runs in its own shell with MAIN, DATA (tests/data) and an empty WORK directory set,
+# and fails by exiting non-zero. A summary is printed and the exit status is 1 if any test failed.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+MAIN=${1:-./main}
+case "$MAIN" in
+    /*) ;;
+    *) MAIN="$ROOT/$MAIN" ;;
+esac
+if [ ! -x "$MAIN" ]; then
+    echo "ERROR: $MAIN not found, build it with make first" >&2
+    exit 1
+fi
+
+# The Makefile links MAIN with the relative rpath ./helper/lib, which stops resolving once a test cd's into WORK
+LD_LIBRARY_PATH="$ROOT/helper/lib${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+export LD_LIBRARY_PATH
+
+Passed=0
+Failed=0
+for Test in "$ROOT"/tests/test_*.sh; do
+    Name=$(basename "$Test" .sh)
+    WORK=$(mktemp -d "${TMPDIR:-/tmp}/sudoku-$Name.XXXXXX")
+    if (cd "$WORK" && MAIN="$MAIN" DATA="$ROOT/tests/data" WORK="$WORK" sh "$Test") > "$WORK.log" 2>&1; then
+        echo "[PASS]: $Name"
+        Passed=$((Passed + 1))
+        rm -f "$WORK.log"
+    else
+        echo "[FAIL]: $Name"
+        sed 's/^/    /' "$WORK.log"
+        Failed=$((Failed + 1))
+        rm -f "$WORK.log"
+    fi
+    rm -rf "$WORK"
+done
+
+echo "[INFO]: $Passed Passed, $Failed Failed"
+[ "$Failed" -eq 0 ]
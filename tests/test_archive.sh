@@ -0,0 +1,61 @@
+# NOTE: Packed Archive: dense and sparse round trips, random access across blocks and bad input
+. "$(dirname "$0")/lib.sh"
+
+# More than one ARCHIVE_BLOCK_SIZE block, so lookups have to go through the block index
+for i in $(seq 400); do cat "$DATA/puzzles.txt"; done > many.txt
+tr -d '\n' < many.txt > many.digits
+
+# Prints the digits of the solved board that `main ARCHIVE INDEX` ends with
+solved_digits() {
+    "$MAIN" "$1" "$2" | grep '^|' | tail -9 | tr -cd '0-9'
+}
+
+for Mode in dense sparse; do
+    Flag=""
+    [ "$Mode" = sparse ] && Flag="--sparse"
+    expect_exit 0 --pack many.txt $Mode.sdka $Flag
+    expect_exit 0 --unpack $Mode.sdka $Mode.txt
+    tr -d '\n' < $Mode.txt > $Mode.digits
+    expect_same many.digits $Mode.digits "$Mode round trip"
+
+    # The unpacked grid layout packs back into the same bytes
+    expect_exit 0 --pack $Mode.txt $Mode.again $Flag
+    expect_same $Mode.sdka $Mode.again "$Mode repack"
+
+    for Index in 0 10 4095 4096 4399; do
+        Line=$((Index % 11 + 1))
+        Expected=$(sed -n "${Line}p" "$DATA/solutions.txt")
+        [ "$(solved_digits $Mode.sdka $Index)" = "$Expected" ] || fail "$Mode puzzle $Index solved wrong"
+    done
+    expect_exit 1 $Mode.sdka 4400
+done
+
+# Sparse storage only pays off because puzzles are mostly empty
+[ "$(wc -c < sparse.sdka)" -lt "$(wc -c < dense.sdka)" ] || fail "sparse archive is not smaller than dense"
+
+# A malformed record fails the pack instead of shifting every puzzle after it
+{ head -3 "$DATA/puzzles.txt"; echo 12345; tail -3 "$DATA/puzzles.txt"; } > bad.txt
+expect_exit 1 --pack bad.txt bad.sdka
+grep -q "Malformed" err || fail "malformed record not reported"
+
+# Corrupt archives are refused with exit 1 instead of sizing allocations, seeks or digits from bad bytes.
+# patch FILE OFFSET OCTAL... overwrites bytes of a copy of dense.sdka in place
+patch() {
+    Out=$1 Offset=$2
+    shift 2
+    cp dense.sdka $Out
+    printf "$(printf '\\%s' "$@")" | dd of=$Out bs=1 seek=$Offset conv=notrunc 2> /dev/null
+}
+Index=$(( $(wc -c < dense.sdka) - 3 * 8 ))
+patch huge_block.sdka 8 377 377 377 377                 # Block Size 2^32 - 1
+patch huge_count.sdka 12 377 377 377 377 377 377 0 0    # more puzzles than the file could hold
+patch past_end.sdka 20 377 377 377 377 0 0 0 0          # Index after the end of the file
+patch bad_entry.sdka $((Index + 8)) 377 377 377 377     # second Block starts past the Index
+patch bad_digit.sdka 32 377                             # first two cells of puzzle 0 decode to 15
+for Corrupt in huge_block huge_count past_end bad_entry; do
+    expect_exit 1 --unpack $Corrupt.sdka $Corrupt.txt
+    grep -q "Corrupt Archive" err || fail "$Corrupt archive not reported as corrupt"
+done
+expect_exit 1 --unpack bad_digit.sdka bad_digit.txt
+grep -q "Corrupt Puzzle 0" err || fail "digit above 9 not refused"
+expect_exit 1 bad_digit.sdka 0
@@ -0,0 +1,20 @@
+# NOTE: Batch Kernel: puzzles that still need guessing after singles propagation match SolveValues
+. "$(dirname "$0")/lib.sh"
+
+# Each branching puzzle is unique, so Search from the givens must find the same grid. Spread among the easy
+# puzzles they share lanes with puzzles the kernel finishes by itself, and the last group leaves lanes unused.
+for i in $(seq 7); do
+    cat "$DATA/puzzles.txt" "$DATA/branching.txt"
+done > mixed.txt
+Branching=$((7 * $(wc -l < "$DATA/branching.txt")))
+
+expect_exit 0 --stream --backend search < mixed.txt
+mv out expected.txt
+expect_exit 0 --stream --backend batch < mixed.txt
+expect_same out expected.txt "batch kernel"
+grep -q "Kernel: $((7 * 11)) Propagated, $Branching Branched, 0 Contradicted" err \
+    || fail "branching puzzles were not all handed over to SolveValues"
+
+# The same puzzles through the scheduler reach the kernel in hardness groups instead of input order
+expect_exit 0 --stream --backend batch --jobs 2 --schedule hardness < mixed.txt
+expect_same out expected.txt "scheduled batch kernel"
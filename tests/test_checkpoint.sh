@@ -0,0 +1,46 @@
+# NOTE: Checkpoint and Resume: a run killed mid-way picks up from its last checkpoint and matches a clean run
+. "$(dirname "$0")/lib.sh"
+
+for i in $(seq 55); do cat "$DATA/puzzles.txt"; done > many.txt
+for i in $(seq 55); do cat "$DATA/solutions.txt"; done > expected.txt
+Batch=$((256 * 82))     # Bytes of one STREAM_BATCH of 81 digit lines, in and out
+
+for Options in "--backend search" "--backend batch --jobs 2 --schedule hardness"; do
+    rm -f out.txt run.ckpt
+
+    # The file size limit kills the run with SIGXFSZ while it writes the second batch, after one checkpoint
+    ( ulimit -f $((Batch * 3 / 2 / 512)); exec "$MAIN" --batch many.txt out.txt --checkpoint run.ckpt --every 1 $Options ) 2> err
+    [ -f run.ckpt ] || fail "$Options: no checkpoint left behind"
+    grep -q "^input_offset $Batch$" run.ckpt || fail "$Options: checkpoint is not at the end of the first batch"
+    grep -q "^output_offset $Batch$" run.ckpt || fail "$Options: checkpoint output offset is wrong"
+    [ "$(wc -c < out.txt)" -gt "$Batch" ] || fail "$Options: the killed run left no partial batch to cut off"
+    case "$Options" in
+        *--jobs*) grep -q "^latency_" run.ckpt || fail "$Options: schedule stats missing from the checkpoint" ;;
+    esac
+
+    # Resuming any other run is refused, keeps the checkpoint and leaves the output alone: a different input, the
+    # same input edited in place (same size), another backend or box size, or another output file
+    cp out.txt killed.txt
+    head -300 many.txt > shorter.txt
+    sed '300s/^./0/' many.txt > edited.txt
+    Other=search
+    [ "${Options#--backend search}" = "$Options" ] || Other=sat
+    for Refused in "shorter.txt out.txt $Options" "edited.txt out.txt $Options" "many.txt out.txt $Options --backend $Other" \
+                   "many.txt out.txt --backend sat --box 4" "many.txt other.txt $Options"; do
+        expect_exit 1 --batch $Refused --checkpoint run.ckpt
+        grep -q "was written for\|was written by" err || fail "$Refused: no reason given for refusing the checkpoint"
+        [ -f run.ckpt ] || fail "$Refused: refused resume removed the checkpoint"
+        expect_same out.txt killed.txt "$Refused: output after a refused resume"
+    done
+    [ ! -e other.txt ] || fail "refused resume created another output file"
+
+    expect_exit 0 --batch many.txt out.txt --checkpoint run.ckpt $Options
+    expect_same out.txt expected.txt "$Options resumed output"
+    grep -q "Resuming after Puzzle 256" err || fail "$Options: did not resume"
+    grep -q "Streamed 605 Puzzles (605 Solved" err || fail "$Options: stats were not carried over"
+    [ ! -f run.ckpt ] || fail "$Options: checkpoint not removed after the run completed"
+done
+
+# The latency histograms restored from the checkpoint cover the puzzles solved before the kill too
+Classes=$(grep -E '^\[INFO\]: (easy|medium|hard) ' err | awk '{ n += $3 } END { print n }')
+[ "$Classes" = 605 ] || fail "per-class latency covers $Classes puzzles, expected 605"
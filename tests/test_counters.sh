@@ -0,0 +1,34 @@
+# NOTE: Performance Counters: --bench and --stream report every counter as a number or n/a and never fail for lack of one
+. "$(dirname "$0")/lib.sh"
+
+Names="task-clock cycles instructions L1D-misses LLC-misses branch-misses"
+
+# Fails unless every counter line in err names every counter, and the ones the kernel refused are n/a on all of them
+check_counters() {
+    Lines=$(grep -c ': task-clock ' err)
+    [ "$Lines" -eq "$1" ] || fail "$2: $Lines counter lines, expected $1"
+    for Name in $Names; do
+        [ "$(grep -c "[:,] $Name \(n/a\|[0-9.]*[ /]\)" err)" -eq "$Lines" ] || fail "$2: $Name missing from a counter line"
+        if grep -q "Counter $Name Unavailable" err; then
+            [ "$(grep -c " $Name n/a" err)" -eq "$Lines" ] || fail "$2: unavailable $Name not reported as n/a"
+        fi
+    done
+    if grep -q "Counter \(cycles\|instructions\) Unavailable" err; then
+        [ "$(grep -c ', IPC n/a$' err)" -eq "$Lines" ] || fail "$2: IPC without cycles and instructions"
+    fi
+}
+
+# One load line per corpus and one line per backend per corpus
+cp "$DATA/puzzles.txt" easy.txt
+cp "$DATA/branching.txt" hard.txt
+expect_exit 0 --bench easy.txt hard.txt --counters
+check_counters $((2 * (1 + 4))) "--bench"
+[ "$(grep -c ' Solved$' err)" -eq 8 ] || fail "--bench did not solve every corpus with every backend"
+
+expect_exit 0 --stream --backend batch --counters < easy.txt
+check_counters 2 "--stream"
+expect_same out "$DATA/solutions.txt" "--stream with counters"
+
+# Without --counters only the wall clock is reported
+expect_exit 0 --bench easy.txt
+! grep -q 'task-clock\|n/a' err || fail "--bench reported counters it was not asked for"
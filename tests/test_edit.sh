@@ -0,0 +1,49 @@
+# NOTE: Edit Mode: conflicts, solvability and hints stay right through placing, replacing and clearing digits
+. "$(dirname "$0")/lib.sh"
+
+Grid="$DATA/../../data/grid1.txt"
+Classic=534678912672195348198342567859761423426853791713924856961537284287419635345286179
+
+# Runs the edit commands on stdin against grid1 and leaves one line per reply in replies (timings and prompts
+# dropped) and the number of conflict marks of every printed board in marks
+edit_session() {
+    expect_exit 0 --edit "$Grid"
+    sed 's/^\(> \)*//' out | grep -E '^(Ok|Conflict|Still|Not|Hint|No Hint|Cannot)' | sed 's/ ([0-9.]* us)$//' > replies
+    sed 's/^\(> \)*//' out | awk '/^\+/ && Row == 9 { print Marks; Row = 0; Marks = 0 }
+                                 /^\|/ { Row++; Marks += gsub(/\*/, "") }' > marks
+}
+
+# Replacing a digit moves its counts: a conflict appears with 5 and goes away again with the right digit
+printf '%s\n' '1 3 4' c '1 3 5' p c h '1 3 4' p c '1 3 0' '1 1 9' q | edit_session
+cat > expected <<'EOF2'
+Ok.
+Still Solvable.
+Conflict!
+Not Solvable.
+No Hint: the Board cannot be completed
+Ok.
+Still Solvable.
+Ok.
+Cannot change that cell.
+EOF2
+expect_same replies expected "replace and clear replies"
+printf '0\n0\n2\n2\n0\n0\n0\n' > expected
+expect_same marks expected "conflict marks of the boards printed along the way"
+
+# A digit that leaves the cached solution makes a unique puzzle unsolvable until it is cleared again,
+# and hints come from a solution that agrees with the classic answer
+printf '%s\n' '1 4 2' c h '1 4 0' c h q | edit_session
+printf 'Ok.\nNot Solvable.\nNo Hint: the Board cannot be completed\nOk.\nStill Solvable.\n' > expected
+head -5 replies > first
+expect_same first expected "unsolvable placement replies"
+set -- $(sed -n 's/^Hint: Row \([1-9]\) Col \([1-9]\) is \([1-9]\)$/\1 \2 \3/p' replies)
+[ $# -eq 3 ] || fail "no hint after clearing the wrong digit"
+[ "$(echo "$Classic" | cut -c$((($1 - 1) * 9 + $2)))" = "$3" ] || fail "hint Row $1 Col $2 is $3, not the solution"
+
+# Filling every empty cell with the answer leaves nothing to hint
+awk -v S="$Classic" '{ for (j = 1; j <= 9; ++j) if (substr($0, j, 1) == "0") print NR, j, substr(S, (NR - 1) * 9 + j, 1) }
+                     END { print "c"; print "h"; print "q" }' "$Grid" | edit_session
+[ "$(grep -c '^Ok\.$' replies)" -eq "$(grep -o 0 "$Grid" | wc -l)" ] || fail "not every answer was accepted"
+tail -2 replies > last
+printf 'Still Solvable.\nNo Hint: the Board is already Solved\n' > expected
+expect_same last expected "solved board replies"
@@ -0,0 +1,60 @@
+# NOTE: Pattern Index: queries agree with a brute force scan over a catalog with bitmap and array chunks
+. "$(dirname "$0")/lib.sh"
+
+# 70000 grids (more than one 65536 entry chunk): the known solutions relabelled by successive permutations of
+# the digits, so each (cell, digit) list is a bitmap in the first chunk and an array in the second
+awk 'NR == FNR { Grid[FNR - 1] = $0; next }
+     END {
+        for (n = 0; n < 70000; ++n) {
+            k = int(n / 11)
+            for (d = 1; d <= 9; ++d) Free[d] = d
+            Left = 9
+            for (d = 1; d <= 9; ++d) {
+                Pick = k % Left + 1
+                k = int(k / Left)
+                Map[d] = Free[Pick]
+                for (i = Pick; i < Left; ++i) Free[i] = Free[i + 1]
+                Left--
+            }
+            Line = ""
+            for (i = 1; i <= 81; ++i) Line = Line Map[substr(Grid[n % 11], i, 1)]
+            print Line
+        }
+     }' "$DATA/solutions.txt" /dev/null > catalog.txt
+
+expect_exit 0 --index catalog.txt catalog.idx
+grep -q "Indexed 70000 Entries" err || fail "not every catalog line was indexed"
+
+# Prints the line numbers (from 0) of the catalog entries that agree with PATTERN, by scanning the catalog
+brute_force() {
+    grep -n "^$(echo "$1" | tr 0 .)\$" catalog.txt | cut -d: -f1 | awk '{ print $1 - 1 }'
+}
+
+Row=$(sed -n 70000p catalog.txt)
+for Pattern in \
+    5$(printf '%080d' 0) \
+    53$(printf '%07d' 0)6$(printf '%071d' 0) \
+    $(printf '%040d' 0)7$(printf '%039d' 0)1 \
+    $(echo "$Row" | cut -c1-27)$(printf '%054d' 0) \
+    "$Row" \
+    11$(printf '%079d' 0); do
+    brute_force "$Pattern" > expected
+    expect_exit 0 --query catalog.idx "$Pattern"
+    expect_same out expected "query $Pattern"
+    expect_exit 0 --query catalog.idx "$Pattern" --count
+    grep -q ": $(wc -l < expected) of 70000 Entries Match" err || fail "count of $Pattern"
+    [ ! -s out ] || fail "--count printed line numbers"
+    expect_exit 0 --query catalog.idx "$Pattern" --limit 3
+    head -3 expected > limited
+    expect_same out limited "limit 3 of $Pattern"
+done
+
+# A pattern can also be a grid file
+echo "$Row" | fold -w 9 > row.txt
+expect_exit 0 --query catalog.idx row.txt
+brute_force "$Row" > expected
+expect_same out expected "grid file pattern"
+
+# A truncated index is refused instead of read past its end
+head -c 100000 catalog.idx > short.idx
+expect_exit 1 --query short.idx "$Row"
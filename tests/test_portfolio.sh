@@ -0,0 +1,24 @@
+# NOTE: Portfolio Solving: the race gives the same answers however many strategies take part
+. "$(dirname "$0")/lib.sh"
+
+# Unique puzzles have one answer whichever member wins; a unique puzzle with one wrong digit has none, which
+# every member must prove before the race can end
+cat "$DATA/puzzles.txt" "$DATA/branching.txt" > unique.txt
+sed '1s/^\(...\)0/\12/' "$DATA/../../data/grid1.txt" | tr -d '\n' > wrong.txt
+echo >> wrong.txt
+cat unique.txt wrong.txt > all.txt
+
+expect_exit 0 --stream --backend search < all.txt
+mv out expected.txt
+for Threads in 1 2 4 16; do
+    expect_exit 0 --stream --backend portfolio --threads $Threads < all.txt
+    expect_same out expected.txt "portfolio with $Threads threads"
+    grep -q "1 Failed" err || fail "portfolio with $Threads threads solved a board that has no solution"
+done
+
+# The single grid front end reports one line per member and exactly one winner
+for Threads in 1 5; do
+    expect_exit 0 --portfolio --threads $Threads "$DATA/../../data/grid1.txt"
+    [ "$(grep -c 'nodes' out)" -eq $Threads ] || fail "--portfolio --threads $Threads did not run $Threads members"
+    [ "$(grep -c '(winner)' out)" -eq 1 ] || fail "--portfolio --threads $Threads did not name one winner"
+done
@@ -0,0 +1,25 @@
+# NOTE: SAT Backend: known answers at box sizes 4 and 5 (every puzzle has exactly one solution) and a fast 9x9 --check
+. "$(dirname "$0")/lib.sh"
+
+for Box in 4 5; do
+    expect_exit 0 --stream --backend sat --box $Box --check < "$DATA/box$Box.txt"
+    expect_same out "$DATA/box${Box}_solutions.txt" "box $Box solutions"
+    grep -q " 0 Mismatched" err || fail "box $Box solutions failed the check"
+
+    # Only the SAT Backend handles boards other than 9x9
+    expect_exit 1 --stream --backend search --box $Box < "$DATA/box$Box.txt"
+done
+
+# A 16x16 board with a repeated given has no solution and is written back unchanged
+printf '11%0254d\n' 0 > conflict.txt
+expect_exit 0 --stream --backend sat --box 4 < conflict.txt
+expect_same out conflict.txt "conflicting 16x16 givens"
+grep -q "1 Failed" err || fail "conflicting 16x16 board not counted as failed"
+
+# A 9x9 puzzle built to stall row-major backtracking: SAT solves it at once and --check must not take longer than
+# that by cross-checking with Search (the CPU limit kills a run that does)
+echo 000000000000003085001020000000507000004000100090000000500000073002010000000040009 > stall.txt
+echo 987654321246173985351928746128537694634892157795461832519286473472319568863745219 > stall.expected
+( ulimit -t 5; exec "$MAIN" --stream --backend sat --check < stall.txt > out 2> err ) || fail "--backend sat --check ran out of time"
+expect_same out stall.expected "stalling puzzle"
+grep -q " 0 Mismatched" err || fail "stalling puzzle failed the check"
@@ -0,0 +1,42 @@
+# NOTE: Hardness-Aware Scheduling: same answers as an unscheduled run, one class per group, hard groups capped
+. "$(dirname "$0")/lib.sh"
+
+# The known puzzles are all easy; the first two rows of their solutions alone (18 clues) count as hard.
+# Each easy puzzle is followed by a hard one, so input order mixes the classes everywhere.
+cut -c1-18 "$DATA/solutions.txt" | awk '{ printf "%s%063d\n", $0, 0 }' > hard.txt
+for i in $(seq 10); do
+    paste -d '\n' "$DATA/puzzles.txt" hard.txt
+done > mixed.txt
+
+for Backend in search batch; do
+    expect_exit 0 --stream --backend $Backend < mixed.txt
+    mv out unscheduled.txt
+    for Schedule in fifo hardness; do
+        expect_exit 0 --stream --backend $Backend --check --jobs 3 --schedule $Schedule < mixed.txt
+        expect_same out unscheduled.txt "$Backend --schedule $Schedule"
+        grep -q "easy *110 Puzzles" err || fail "$Backend --schedule $Schedule: easy puzzles not counted"
+        grep -q "hard *110 Puzzles" err || fail "$Backend --schedule $Schedule: hard puzzles not counted"
+    done
+done
+
+# The batch kernel takes BATCH_LANES puzzles at once: in input order they mix classes, by hardness they never do
+expect_exit 0 --stream --backend batch --jobs 2 --schedule fifo < mixed.txt
+grep -q "Groups ([1-9][0-9]* Mixing Classes)" err || fail "fifo groups of interleaved input did not mix classes"
+expect_exit 0 --stream --backend batch --jobs 2 --schedule hardness < mixed.txt
+grep -q "Groups (0 Mixing Classes)" err || fail "hardness groups mixed classes"
+
+# With more threads than the cap, hard puzzles never take more than K of them while easy ones wait
+for Cap in 1 2; do
+    expect_exit 0 --stream --jobs 4 --schedule hardness --max-hard $Cap < mixed.txt
+    Peak=$(sed -n 's/.*at most \([0-9]*\) Hard Groups.*/\1/p' err)
+    [ -n "$Peak" ] && [ "$Peak" -le $Cap ] || fail "--max-hard $Cap let ${Peak:-?} hard groups run at once"
+    expect_same out unscheduled.txt "--max-hard $Cap"
+done
+
+# Scheduling options that would be ignored are refused
+expect_exit 1 --stream --schedule hardness < mixed.txt
+grep -q "need --jobs" err || fail "--schedule hardness without --jobs not refused"
+expect_exit 1 --stream --jobs 2 --max-hard 1 < mixed.txt
+grep -q "needs --schedule hardness" err || fail "--max-hard without --schedule hardness not refused"
+expect_exit 1 --stream --jobs 2 --box 4 --backend sat < "$DATA/box4.txt"
+grep -q "only schedules 9x9" err || fail "--jobs with --box 4 not refused"
@@ -0,0 +1,39 @@
+# NOTE: Sharded Runs: merged shard outputs match one streamed run, on any layout, box size and launcher
+. "$(dirname "$0")/lib.sh"
+
+for i in $(seq 20); do cat "$DATA/puzzles.txt"; done > many.txt
+for i in $(seq 20); do cat "$DATA/solutions.txt"; done > expected.txt
+
+expect_exit 0 --coordinate many.txt merged.txt --workers 2 --shards 5
+expect_same merged.txt expected.txt "one line records"
+grep -q "Merged 5 Shards" err || fail "shards were not all merged"
+
+# Grid layout records span 10 lines, and the shard cuts must not land inside one
+while read -r Puzzle; do
+    echo "$Puzzle" | fold -w 9
+    echo
+done < many.txt > grids.txt
+expect_exit 0 --coordinate grids.txt merged.txt --workers 3 --shards 7
+expect_same merged.txt expected.txt "grid layout records"
+
+# Stream options after the coordinator options reach the workers
+for i in $(seq 10); do cat "$DATA/box4.txt"; done > box4.txt
+for i in $(seq 10); do cat "$DATA/box4_solutions.txt"; done > box4.expected
+expect_exit 0 --coordinate box4.txt merged.txt --workers 2 --shards 3 --box 4 --backend sat
+expect_same merged.txt box4.expected "box 4 through sat"
+
+# A worker that fails is run again through the same launcher, and the merge is unaffected
+cat > flaky.sh <<'EOF'
+mkdir "$(dirname "$0")/failed.once" 2> /dev/null && exit 3
+exec "$@"
+EOF
+expect_exit 0 --coordinate many.txt merged.txt --workers 2 --shards 4 --launcher "sh $WORK/flaky.sh"
+expect_same merged.txt expected.txt "retried shard"
+grep -q "Retrying" err || fail "the failed shard was not retried"
+
+# Malformed records become aligned ERROR lines in the merged output and fail the run
+{ head -30 many.txt; echo 12345; tail -n +31 many.txt; } > bad.txt
+{ head -30 expected.txt; echo ERROR; tail -n +31 expected.txt; } > bad.expected
+expect_exit 1 --coordinate bad.txt merged.txt --workers 2 --shards 4
+expect_same merged.txt bad.expected "malformed record"
+grep -q "Malformed Records" err || fail "malformed records not reported"
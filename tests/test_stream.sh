@@ -0,0 +1,29 @@
+# NOTE: Streaming Mode: known answers on every 9x9 backend, grid layout input, malformed and unsolvable records
+. "$(dirname "$0")/lib.sh"
+
+for Backend in search sat batch portfolio; do
+    expect_exit 0 --stream --backend $Backend --check < "$DATA/puzzles.txt"
+    expect_same out "$DATA/solutions.txt" "$Backend solutions"
+done
+
+# The same puzzles as 9 line grids separated by blank lines give the same output
+while read -r Puzzle; do
+    echo "$Puzzle" | fold -w 9
+    echo
+done < "$DATA/puzzles.txt" > grids.txt
+expect_exit 0 --stream < grids.txt
+expect_same out "$DATA/solutions.txt" "grid layout"
+
+# A malformed record becomes one ERROR line in its place and fails the run; the records around it are unaffected
+{ head -2 "$DATA/puzzles.txt"; echo 12345; sed -n 3p "$DATA/puzzles.txt"; } > bad.txt
+{ head -2 "$DATA/solutions.txt"; echo ERROR; sed -n 3p "$DATA/solutions.txt"; } > bad.expected
+expect_exit 1 --stream < bad.txt
+expect_same out bad.expected "malformed record"
+
+# Givens that already repeat a digit are written back unchanged on every backend
+echo 11$(printf '%079d' 0) > conflict.txt
+for Backend in search sat batch portfolio; do
+    expect_exit 0 --stream --backend $Backend < conflict.txt
+    expect_same out conflict.txt "$Backend conflicting givens"
+    grep -q "1 Failed" err || fail "$Backend did not count the conflicting board as failed"
+done
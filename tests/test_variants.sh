@@ -0,0 +1,89 @@
+# NOTE: Variant Plugins: known answers and rule checks for classic, diagonal, jigsaw, even/odd and killer grids
+. "$(dirname "$0")/lib.sh"
+
+Examples="$DATA/../../data"
+
+# Prints the digits of the solved board that `main GRID` ends with
+solved_digits() {
+    grep '^|' out | tail -9 | tr -cd '0-9'
+}
+
+# Fails unless DIGITS keeps the givens of the variant grid FILE and follows every rule it names
+check_rules() {
+    awk -v S="$2" '
+        function unit(name, cells,    n, i, seen, d) {
+            n = split(cells, c, " ")
+            for (i = 1; i <= n; ++i) {
+                d = substr(S, c[i] + 1, 1)
+                if (d == "0" || (d in seen)) { print name " repeats " d; bad = 1 }
+                seen[d] = 1
+            }
+        }
+        NR <= 9 { for (j = 0; j < 9; ++j) Given[(NR - 1) * 9 + j] = substr($0, j + 1, 1); next }
+        NR == 10 { Kind = $1; next }
+        NR <= 19 { for (j = 0; j < 9; ++j) Symbol[(NR - 11) * 9 + j] = substr($0, j + 1, 1); next }
+        { Sum[$1] = $2 }
+        END {
+            if (length(S) != 81) { print "no solution printed"; exit 1 }
+            for (i = 0; i < 81; ++i) {
+                d = substr(S, i + 1, 1)
+                if (Given[i] != "0" && Given[i] != d) { print "given " i " changed"; bad = 1 }
+                Row[int(i / 9)] = Row[int(i / 9)] " " i
+                Col[i % 9] = Col[i % 9] " " i
+                Region[Kind == "jigsaw" ? Symbol[i] : int(i / 27) * 3 + int(i % 9 / 3)] = Region[Kind == "jigsaw" ? Symbol[i] : int(i / 27) * 3 + int(i % 9 / 3)] " " i
+                if (Kind == "evenodd" && ((Symbol[i] == "E" && d % 2) || (Symbol[i] == "O" && !(d % 2)))) { print "parity of " i; bad = 1 }
+                if (Kind == "killer") { Cage[Symbol[i]] = Cage[Symbol[i]] " " i; Total[Symbol[i]] += d }
+            }
+            for (k in Row) unit("row " k, Row[k])
+            for (k in Col) unit("column " k, Col[k])
+            for (k in Region) unit("region " k, Region[k])
+            if (Kind == "diagonal") {
+                for (i = 0; i < 9; ++i) { Main = Main " " i * 10; Anti = Anti " " (i + 1) * 8 }
+                unit("main diagonal", Main)
+                unit("anti diagonal", Anti)
+            }
+            for (k in Cage) {
+                unit("cage " k, Cage[k])
+                if (Total[k] != Sum[k]) { print "cage " k " sums to " Total[k]; bad = 1 }
+            }
+            exit bad
+        }' "$1" || fail "$1: solution $2 breaks a rule"
+}
+
+# Classic: the unique solution of the example grid
+Classic=534678912672195348198342567859761423426853791713924856961537284287419635345286179
+expect_exit 0 "$Examples/grid1.txt"
+[ "$(solved_digits)" = "$Classic" ] || fail "classic grid solved wrong"
+grep -q "^Board Solved\.$" out || fail "classic grid not reported as classic"
+
+# Jigsaw and Killer examples follow their regions, cages and sums
+for Kind in jigsaw killer; do
+    expect_exit 0 "$Examples/$Kind.txt"
+    grep -q "^Board Solved ($Kind)\.$" out || fail "$Kind variant not reported"
+    check_rules "$Examples/$Kind.txt" "$(solved_digits)"
+done
+
+# Diagonal: an empty grid gets both diagonals right, and the classic puzzle (whose only solution repeats
+# digits on a diagonal) has no diagonal solution
+Empty=$(printf '000000000\n%.0s' $(seq 9))
+printf '%s\ndiagonal\n' "$Empty" > diagonal.txt
+expect_exit 0 diagonal.txt
+check_rules diagonal.txt "$(solved_digits)"
+{ head -9 "$Examples/grid1.txt"; echo diagonal; } > diagonal_none.txt
+expect_exit 1 diagonal_none.txt
+grep -q "^InValid Board\.$" out || fail "diagonal grid without a solution not reported"
+
+# Even/Odd: the parity of the classic solution pins an empty grid to a valid board, and flipping one
+# cell of it makes the classic puzzle unsolvable
+Parity=$(echo "$Classic" | tr 02468 EEEEE | tr 13579 OOOOO | fold -w 9)
+printf '%s\nevenodd\n%s\n' "$Empty" "$Parity" > evenodd.txt
+expect_exit 0 evenodd.txt
+grep -q "^Board Solved (evenodd)\.$" out || fail "evenodd variant not reported"
+check_rules evenodd.txt "$(solved_digits)"
+{ head -9 "$Examples/grid1.txt"; echo evenodd; echo "$Parity" | sed '1s/^O/E/'; } > evenodd_none.txt
+expect_exit 1 evenodd_none.txt
+
+# Givens that already break a rule are refused before solving
+{ echo 110000000; sed -n 2,9p "$Examples/grid1.txt"; } > conflict.txt
+expect_exit 1 conflict.txt
+grep -q "^InValid Board\.$" out || fail "conflicting givens not reported"